@@ -48,10 +48,18 @@
 #define MAX_FILE_SIZE   (100*1000*1024) // 200 KB
 #define MAX_FILE_SIZE_STR "100MB"
 
-/* Scratch buffer size */
+/* Size of I/O buffer leased from the pool for request handling */
 #define SCRATCH_BUFSIZE  EXPECTED_MAX_DATA_SIZE
 #define AUTH_DATA_MAX_LENGTH 16
 
+/* Content codings accepted by client */
+#define HTTP_ENCODING_GZIP  (1 << 0)
+#define HTTP_ENCODING_BR    (1 << 1)
+
+/* Input block and output buffer size of on-the-fly gzip encoder */
+#define HTTP_DEFLATE_BLOCK_SIZE 4096
+#define HTTP_DEFLATE_OUT_SIZE   (HTTP_DEFLATE_BLOCK_SIZE + HTTP_DEFLATE_BLOCK_SIZE / 8 + 32)
+
 #define HTTP_SERVER_DEBUG_LEVEL 0
 #define FILE_SERVER_DEBUG_LEVEL 0
 
@@ -72,11 +80,114 @@ struct file_server_data
     /* Base path of file storage */
     char base_path[ESP_VFS_PATH_MAX + 1];
     char base_path2[ESP_VFS_PATH_MAX + 1];
-    /* Scratch buffer for temporary storage during file transfer */
-    char scratch[SCRATCH_BUFSIZE];
-/* Pointer to external POST handler*/
 };
 
+/* Statistics of I/O buffers pool shared by HTTP handlers */
+typedef struct
+{
+    int size;
+    int in_use;
+    int peak;
+    uint32_t leases;
+    uint32_t waits;
+    uint32_t exhausted;
+} http_buf_pool_stat_t;
+
+typedef struct http_deflate_s http_deflate_t;
+typedef struct http_tpl_s http_tpl_t;
+
+/* Statistics of the last file upload */
+typedef struct
+{
+    uint32_t uploads;
+    uint32_t bytes;
+    uint32_t time_ms;
+    uint32_t kB_per_s;      /* Kilobytes per second */
+    uint32_t blocked_ms;    /* Receiving waited for storage */
+    uint32_t write_ms;      /* Spent in file writes */
+} http_upload_stat_t;
+
+/* Requests rejected by admission control */
+typedef struct
+{
+    uint32_t limited;   /* 429, client exceeded rate */
+    uint32_t busy;      /* 503, too many expensive requests */
+    int expensive_active;
+} http_limits_stat_t;
+
+/* File content kept in RAM by HTTP cache */
+typedef struct
+{
+    char *key;
+    char *data;
+    size_t size;
+    long version;
+    uint32_t last_use;
+    int refs;
+    bool stale;
+} http_cache_entry_t;
+
+typedef struct
+{
+    size_t budget;
+    size_t bytes;
+    int entries;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+} http_cache_stat_t;
+
+/* Buffer of response writer fits one TCP segment */
+#ifdef CONFIG_LWIP_TCP_MSS
+#define HTTP_WRITER_BUFSIZE CONFIG_LWIP_TCP_MSS
+#else
+#define HTTP_WRITER_BUFSIZE 1436
+#endif
+
+typedef struct
+{
+    httpd_req_t *req;
+    char *buf;
+    size_t size;
+    size_t len;
+    esp_err_t err;
+} http_writer_t;
+
+#define HTTP_JSON_MAX_DEPTH 32
+
+/* State of incremental JSON structure check */
+typedef struct
+{
+    uint32_t brackets;  /* Stack of open brackets, bit set for '[' */
+    int depth;
+    bool in_string;
+    bool escape;
+    bool done;
+    bool error;
+} http_json_scan_t;
+
+typedef enum
+{
+    HTTP_ROUTE_EXACT = 0,
+    HTTP_ROUTE_PREFIX
+} http_route_match_t;
+
+/* Route handler is executed by async worker task, not by httpd task */
+#define HTTP_ROUTE_FLAG_ASYNC   (1 << 0)
+/* Route has own rate limit and limited number of concurrent requests */
+#define HTTP_ROUTE_FLAG_EXPENSIVE   (1 << 1)
+
+typedef struct
+{
+    int id; /* Index in order of registration */
+    const char *uri;
+    size_t urilen;
+    httpd_method_t method;
+    http_route_match_t match;
+    int flags;
+    esp_err_t (*handler)(httpd_req_t *req);
+} http_route_t;
+
 typedef struct
 {
     const char tag[16];
@@ -102,12 +213,73 @@ typedef struct
 } cb_blockdata_transfer_t;
 
 esp_err_t start_file_server(void);
+uint32_t HTTPGetRestartsAvoided(void);
 HTTP_IO_RESULT HTTPPostApp(httpd_req_t *req, const char *filename, char *PostData);
 int HTTPPrint(httpd_req_t *req, char* buf, char* var);
 HTTP_IO_RESULT HTTPPostSysAPI(httpd_req_t *req, char *PostData);
+void HTTPJSONScanInit(http_json_scan_t *js);
+bool HTTPJSONScanFeed(http_json_scan_t *js, const char *data, size_t len);
+bool HTTPJSONScanComplete(http_json_scan_t *js);
+
+const char* GetMIMEType(const char *filename);
+bool IsCompressibleMIMEType(const char *mime);
+int HTTPGetAcceptedEncodings(httpd_req_t *req);
+
+http_deflate_t* HTTPDeflateBegin(void);
+const uint8_t* HTTPDeflateChunk(http_deflate_t *d, const uint8_t *in, size_t len, bool last, size_t *outlen);
+void HTTPDeflateEnd(http_deflate_t *d);
+
+http_tpl_t* HTTPTemplateParse(const romfs_asset_t *asset);
+esp_err_t HTTPTemplateRender(httpd_req_t *req, const http_tpl_t *tpl);
+
+esp_err_t HTTPRouteRegister(const char *uri, httpd_method_t method, http_route_match_t match, int flags,
+                            esp_err_t (*handler)(httpd_req_t *req));
+const http_route_t* HTTPRouteFind(httpd_method_t method, const char *uri);
+esp_err_t HTTPRouteExecute(httpd_req_t *req, const http_route_t *route);
+void HTTPRequestComplete(httpd_req_t *req, const http_route_t *route, esp_err_t res);
+
+esp_err_t HTTPAdmissionCheck(httpd_req_t *req, const http_route_t *route);
+void HTTPAdmissionRelease(const http_route_t *route);
+void HTTPGetLimitsStat(http_limits_stat_t *stat);
+
+void HTTPMetricsConnection(bool open);
+void HTTPMetricsBegin(void);
+void HTTPMetricsRecord(const http_route_t *route, int status, size_t in, size_t out, int64_t us, bool failed);
+void HTTPMetricsPrint(char *buf, size_t size);
+
+esp_err_t HTTPWebSocketInit(void);
+esp_err_t HTTPWebSocketHandler(httpd_req_t *req);
+void HTTPWebSocketRemove(int fd);
+
+esp_err_t HTTPAsyncInit(void);
+esp_err_t HTTPAsyncSubmit(httpd_req_t *req, const http_route_t *route);
+
+bool HTTPIsAuthorized(httpd_req_t *req);
+esp_err_t HTTPAuthCheckSession(httpd_req_t *req);
+esp_err_t HTTPAuthLoginHandler(httpd_req_t *req);
+esp_err_t HTTPAuthLogoutHandler(httpd_req_t *req);
+
+esp_err_t HTTPBufPoolInit(void);
+esp_err_t HTTPCacheInit(void);
+const http_cache_entry_t* HTTPCacheGet(const char *key, long version, size_t size,
+                                       bool (*fill)(const char *key, char *buf, size_t size));
+void HTTPCacheRelease(const http_cache_entry_t *entry);
+void HTTPCacheInvalidate(const char *key);
+void HTTPCacheGetStat(http_cache_stat_t *stat);
+char* HTTPBufLease(void);
+void HTTPBufRelease(char *buf);
+void HTTPBufPoolGetStat(http_buf_pool_stat_t *stat);
+esp_err_t HTTPRespSendBusy(httpd_req_t *req);
+
+void HTTPWriterInit(http_writer_t *w, httpd_req_t *req, char *buf, size_t size);
+esp_err_t HTTPWrite(http_writer_t *w, const char *data, size_t len);
+esp_err_t HTTPWriteStr(http_writer_t *w, const char *str);
+esp_err_t HTTPWriterFlush(http_writer_t *w);
+esp_err_t HTTPWriterEnd(http_writer_t *w);
 
 esp_err_t download_get_handler(httpd_req_t *req);
 esp_err_t upload_post_handler(httpd_req_t *req);
+void HTTPGetUploadStat(http_upload_stat_t *stat);
 esp_err_t delete_post_handler(httpd_req_t *req);
 
 esp_err_t ParseBlockDataObject(char *argres, cb_blockdata_transfer_t *ft);
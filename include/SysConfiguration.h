@@ -30,10 +30,15 @@
 #include "sdkconfig.h"
 #include "CronTimers.h"
 
+/* RP marks VAR_FUNCT which getter has no side effects and takes no
+ * argument, only such function variables are read by GET /api/vars,
+ * wildcard reads and push to subscribers */
 typedef enum
 {
     R = 0,
     RW,
+    RP,
+    RWP,
 }rest_var_attr;
 
 typedef enum{
@@ -47,7 +52,10 @@ typedef enum{
 	VAR_CHAR
 } rest_var_types;
 
-
+/* Caching of VAR_FUNCT values read, positive cachems is the time in ms
+ * the value is kept for */
+#define VAR_CACHE_LIVE 0      //function is called on every read
+#define VAR_CACHE_BOOT (-1)   //value doesn't change after boot
 
 typedef struct
 {
@@ -58,6 +66,7 @@ typedef struct
   rest_var_attr varattr;
   int minlen;
   int maxlen;
+  int cachems;
 } rest_var_t;
 
 
@@ -114,8 +114,15 @@ void InitSerialPort(void);
 void InitSysSDCard();
 esp_err_t TransmitSerialPort(char *data, int ln);
 
+esp_err_t BuildConfVarsIndex(void);
 esp_err_t GetConfVar(char* name, char* val, rest_var_types *tp);
 esp_err_t SetConfVar(char* name, char* val, rest_var_types *tp);
+bool IsConfVarReadSafe(char *name);
+int ConfVarsForEach(const char *pattern, uint32_t since, void (*cb)(char *name, void *arg), void *arg);
+void ConfVarTouch(const char *name);
+uint32_t GetConfVarVersion(const char *name);
+uint32_t GetConfVarsGeneration(void);
+bool IsConfVarChangedSince(const char *name, uint32_t since);
 
 esp_err_t ServiceDataHandler(data_message_t *MSG);
 sys_error_code SysVarsPayloadHandler(data_message_t *MSG);
@@ -38,6 +38,15 @@ void regHTTPUserAppHandlers(char *url,
                             esp_err_t (*get)(httpd_req_t *req),
                             esp_err_t (*post)(httpd_req_t *req));
 
+//Register user HTTP handler for exact URI or URI prefix, routes must be registered before server start
+//Slow handlers should set HTTP_ROUTE_FLAG_ASYNC to be executed outside of httpd task
+//Costly handlers should set HTTP_ROUTE_FLAG_EXPENSIVE to be rate limited as /api
+esp_err_t regHTTPUserRoute(const char *uri,
+                           httpd_method_t method,
+                           http_route_match_t match,
+                           int flags,
+                           esp_err_t (*handler)(httpd_req_t *req));
+
 
 //User handler for various payload types
 void regCustomPayloadTypeHandler(sys_error_code (*payload_handler)(data_message_t *MSG));
@@ -28,7 +28,27 @@
 #include "libespfs/espfs_format.h"
 #include "libespfs/vfs.h"
 
+#define ROMFS_ETAG_LENGTH 24
+
+/* Precomputed information about a file in the ROM file system.
+ * Table of all files is built once on mount and sorted by path, so
+ * the request handler gets all response headers with one lookup.
+ * Precompressed variants like app.js.gz and app.js.br are linked
+ * to the identity file app.js */
+typedef struct romfs_asset_s
+{
+    const char *path;
+    const char *mime;
+    const void *data; /* Mapped content if file is not compressed by espfs, else NULL */
+    size_t size;
+    const char *encoding; /* Content-Encoding of stored content, NULL for identity */
+    const struct romfs_asset_s *gz;
+    const struct romfs_asset_s *br;
+    const struct http_tpl_s *tpl; /* Parsed page with variable markers, else NULL */
+    char etag[ROMFS_ETAG_LENGTH];
+} romfs_asset_t;
 
 void init_rom_fs(const char *root);
+const romfs_asset_t* GetROMAsset(const char *path);
 
 #endif /* COMPONENTS_WEB_GUI_APPLICATION_INCLUDE_ROMFS_H_ */
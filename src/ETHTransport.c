@@ -29,6 +29,7 @@
 #include "esp_event.h"
 #include "driver/gpio.h"
 #include "NetTransport.h"
+#include "SystemApplication.h"
 #include "sdkconfig.h"
 #if CONFIG_ETH_USE_SPI_ETHERNET
 #include "driver/spi_master.h"
@@ -119,6 +120,9 @@ static void got_ip_event_handler(void *arg, esp_event_base_t event_base,
     memcpy(&GetSysConf()->ethSettings.IPAddr, &event->ip_info.ip, sizeof(event->ip_info.ip));
     memcpy(&GetSysConf()->ethSettings.Mask, &event->ip_info.netmask, sizeof(event->ip_info.netmask));
     memcpy(&GetSysConf()->ethSettings.Gateway, &event->ip_info.gw, sizeof(event->ip_info.gw));
+    ConfVarTouch("eth_ip");
+    ConfVarTouch("eth_mask");
+    ConfVarTouch("eth_gw");
 #endif
     ESP_LOGI(TAG, "Ethernet Got IP Address");
     ESP_LOGI(TAG, "~~~~~~~~~~~");
@@ -210,6 +210,10 @@ void FileBlockHandler(char *argres, int rw, const char *path)
         }
     }
 
+#if CONFIG_WEBGUIAPP_HTTP_CACHE_ENABLE
+    if (FileTransaction.opertype == WRITE_ORERATION || FileTransaction.opertype == DELETE_ORERATION)
+        HTTPCacheInvalidate(FileTransaction.filepath);
+#endif
     if (FileTransaction.opertype == DELETE_ORERATION)
     {
         unlink(FileTransaction.filepath);
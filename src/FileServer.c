@@ -22,6 +22,10 @@
  */
 
 #include "HTTPServer.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 
 static const char *TAG = "FileServer";
 
@@ -35,50 +39,6 @@ static esp_err_t index_html_get_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
-#define IS_FILE_EXT(filename, ext) \
-    (strcasecmp(&filename[strlen(filename) - sizeof(ext) + 1], ext) == 0)
-
-/* Set HTTP response content type according to file extension */
-static esp_err_t set_content_type_from_file(httpd_req_t *req,
-                                            const char *filename)
-{
-    if (IS_FILE_EXT(filename, ".pdf"))
-    {
-        return httpd_resp_set_type(req, "application/pdf");
-    }
-    else if (IS_FILE_EXT(filename, ".html"))
-    {
-        return httpd_resp_set_type(req, "text/html");
-    }
-    else if (IS_FILE_EXT(filename, ".jpeg"))
-    {
-        return httpd_resp_set_type(req, "image/jpeg");
-    }
-    else if (IS_FILE_EXT(filename, ".png"))
-    {
-        return httpd_resp_set_type(req, "image/png");
-    }
-    else if (IS_FILE_EXT(filename, ".ico"))
-    {
-        return httpd_resp_set_type(req, "image/x-icon");
-    }
-    else if (IS_FILE_EXT(filename, ".css"))
-    {
-        return httpd_resp_set_type(req, "text/css");
-    }
-    else if (IS_FILE_EXT(filename, ".woff2"))
-    {
-        return httpd_resp_set_type(req, "font/woff2");
-    }
-    else if (IS_FILE_EXT(filename, ".json"))
-    {
-        return httpd_resp_set_type(req, "application/json");
-    }
-    /* This is a limited set only */
-    /* For any other type always set as plain text */
-    return httpd_resp_set_type(req, "text/plain");
-}
-
 /* Copies the full path into destination buffer and returns
  * pointer to path (skipping the preceding base path) */
 static const char* get_path_from_uri(char *dest, const char *base_path,
@@ -140,8 +100,18 @@ static esp_err_t http_resp_dir_html(httpd_req_t *req, const char *dirpath)
         return ESP_FAIL;
     }
 
+    /* Small pieces of the page are gathered and sent by full TCP segments */
+    char *wbuf = HTTPBufLease();
+    if (!wbuf)
+    {
+        closedir(dir);
+        return HTTPRespSendBusy(req);
+    }
+    http_writer_t w;
+    HTTPWriterInit(&w, req, wbuf, MIN(HTTP_WRITER_BUFSIZE, SCRATCH_BUFSIZE));
+
     /* Send HTML file header */
-    httpd_resp_sendstr_chunk(req, "<!DOCTYPE html><html><body style=\"font-family: monospace;\"");
+    HTTPWriteStr(&w, "<!DOCTYPE html><html><body style=\"font-family: monospace;\"");
 
     /* Get handle to embedded file upload script */
     extern const unsigned char upload_script_start[] asm("_binary_upload_script_html_start");
@@ -149,18 +119,18 @@ static esp_err_t http_resp_dir_html(httpd_req_t *req, const char *dirpath)
     const size_t upload_script_size = (upload_script_end - upload_script_start);
 
     /* Add file upload form and script which on execution sends a POST request to /upload */
-    httpd_resp_send_chunk(req, (const char*) upload_script_start, upload_script_size);
+    HTTPWrite(&w, (const char*) upload_script_start, upload_script_size);
 
     /* Send file-list table definition and column labels */
-    httpd_resp_sendstr_chunk(
-            req,
+    HTTPWriteStr(
+            &w,
             "<table border=\"0\">"
             "<col width=\"600px\" /><col width=\"200px\" /><col width=\"200px\" /><col width=\"100px\" />"
             "<thead><tr><th>Name</th><th>Type</th><th>Size (Bytes)</th><th>Delete</th></tr></thead>"
             "<tbody>");
 
     /* Iterate over all files / folders and fetch their names and sizes */
-    while ((entry = readdir(dir)) != NULL)
+    while ((entry = readdir(dir)) != NULL && w.err == ESP_OK)
     {
         entrytype = (entry->d_type == DT_DIR ? "directory" : "file");
 
@@ -174,37 +144,174 @@ static esp_err_t http_resp_dir_html(httpd_req_t *req, const char *dirpath)
 #if FILE_SERVER_DEBUG_LEVEL > 0
         ESP_LOGI(TAG, "Found %s : %s (%s bytes)", entrytype, entry->d_name, entrysize);
 #endif
-        /* Send chunk of HTML file containing table entries with file name and size */
-        httpd_resp_sendstr_chunk(req, "<tr><td><a href=\"");
-        httpd_resp_sendstr_chunk(req, req->uri);
-        httpd_resp_sendstr_chunk(req, entry->d_name);
+        /* Add table entry with file name and size */
+        HTTPWriteStr(&w, "<tr><td><a href=\"");
+        HTTPWriteStr(&w, req->uri);
+        HTTPWriteStr(&w, entry->d_name);
         if (entry->d_type == DT_DIR)
         {
-            httpd_resp_sendstr_chunk(req, "/");
+            HTTPWriteStr(&w, "/");
         }
-        httpd_resp_sendstr_chunk(req, "\">");
-        httpd_resp_sendstr_chunk(req, entry->d_name);
-        httpd_resp_sendstr_chunk(req, "</a></td><td>");
-        httpd_resp_sendstr_chunk(req, entrytype);
-        httpd_resp_sendstr_chunk(req, "</td><td>");
-        httpd_resp_sendstr_chunk(req, entrysize);
-        httpd_resp_sendstr_chunk(req, "</td><td>");
-        httpd_resp_sendstr_chunk(req, "<form method=\"post\" action=\"/storage/delete/");
-        //httpd_resp_sendstr_chunk(req, req->uri);
-        httpd_resp_sendstr_chunk(req, entry->d_name);
-        httpd_resp_sendstr_chunk(req, "\"><button type=\"submit\">Delete</button></form>");
-        httpd_resp_sendstr_chunk(req, "</td></tr>\n");
+        HTTPWriteStr(&w, "\">");
+        HTTPWriteStr(&w, entry->d_name);
+        HTTPWriteStr(&w, "</a></td><td>");
+        HTTPWriteStr(&w, entrytype);
+        HTTPWriteStr(&w, "</td><td>");
+        HTTPWriteStr(&w, entrysize);
+        HTTPWriteStr(&w, "</td><td>");
+        HTTPWriteStr(&w, "<form method=\"post\" action=\"/storage/delete/");
+        HTTPWriteStr(&w, entry->d_name);
+        HTTPWriteStr(&w, "\"><button type=\"submit\">Delete</button></form>");
+        HTTPWriteStr(&w, "</td></tr>\n");
     }
     closedir(dir);
 
     /* Finish the file list table */
-    httpd_resp_sendstr_chunk(req, "</tbody></table>");
+    HTTPWriteStr(&w, "</tbody></table>");
 
     /* Send remaining chunk of HTML file to complete it */
-    httpd_resp_sendstr_chunk(req, "</body></html>");
+    HTTPWriteStr(&w, "</body></html>");
+
+    /* Flush and send empty chunk to signal HTTP response completion */
+    HTTPWriterEnd(&w);
+    HTTPBufRelease(wbuf);
+    if (w.err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Directory listing sending failed!");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+#define HTTP_MAX_RANGES 8
+#define RANGE_BOUNDARY "WEBGUIAPP_BYTERANGES"
+
+typedef struct
+{
+    long start;
+    long len;
+} file_range_t;
+
+/* Parse Range header of request to the file of given size.
+ * Returns number of ranges, 0 if whole file must be sent or -1 if
+ * none of ranges is satisfiable. Range with wrong syntax or with
+ * If-Range not matching current ETag is ignored */
+static int parse_range_request(httpd_req_t *req, const char *etag, long size, file_range_t *ranges)
+{
+    char hdr[128];
+    char ifrange[40];
+    char *save, *tok, *end;
+    int n = 0;
+    if (httpd_req_get_hdr_value_str(req, "Range", hdr, sizeof(hdr)) != ESP_OK)
+        return 0;
+    if (httpd_req_get_hdr_value_len(req, "If-Range") > 0 &&
+            (httpd_req_get_hdr_value_str(req, "If-Range", ifrange, sizeof(ifrange)) != ESP_OK ||
+                    strcmp(ifrange, etag)))
+        return 0;
+    if (strncmp(hdr, "bytes=", sizeof("bytes=") - 1))
+        return 0;
+    for (tok = strtok_r(hdr + sizeof("bytes=") - 1, ",", &save); tok; tok = strtok_r(NULL, ",", &save))
+    {
+        long first, last;
+        while (*tok == ' ')
+            tok++;
+        char *dash = strchr(tok, '-');
+        if (!dash)
+            return 0;
+        if (dash == tok)
+        {
+            /* Suffix range "-N" is the last N bytes */
+            long suffix = strtol(dash + 1, &end, 10);
+            if (end == dash + 1 || (*end && *end != ' '))
+                return 0;
+            if (suffix == 0)
+                continue;
+            first = MAX(size - suffix, 0);
+            last = size - 1;
+        }
+        else
+        {
+            first = strtol(tok, &end, 10);
+            if (end != dash)
+                return 0;
+            last = strtol(dash + 1, &end, 10);
+            if (end == dash + 1)
+                last = size - 1;
+            else if (last < first)
+                return 0;
+            if (*end && *end != ' ')
+                return 0;
+            if (first >= size)
+                continue;
+            last = MIN(last, size - 1);
+        }
+        if (n >= HTTP_MAX_RANGES)
+            return 0;
+        ranges[n].start = first;
+        ranges[n].len = last - first + 1;
+        n++;
+    }
+    return (n > 0) ? n : -1;
+}
+
+#if CONFIG_WEBGUIAPP_HTTP_CACHE_ENABLE
+static bool read_cached_file(const char *path, char *buf, size_t size)
+{
+    FILE *fd = fopen(path, "r");
+    if (!fd)
+        return false;
+    bool res = (fread(buf, 1, size, fd) == size);
+    fclose(fd);
+    return res;
+}
+#endif
+
+static void close_file(FILE *fd, const http_cache_entry_t *entry)
+{
+    if (fd)
+        fclose(fd);
+#if CONFIG_WEBGUIAPP_HTTP_CACHE_ENABLE
+    HTTPCacheRelease(entry);
+#endif
+}
 
-    /* Send empty chunk to signal HTTP response completion */
-    httpd_resp_sendstr_chunk(req, NULL);
+/* Send len bytes of file starting from offset, gzip encoded if deflate is set.
+ * Content is taken from cached copy if it is not NULL, else read from fd */
+static esp_err_t send_file_part(httpd_req_t *req, FILE *fd, const char *cached, char *chunk, long offset,
+                                long len, http_deflate_t *deflate)
+{
+    size_t readsize = (deflate) ? HTTP_DEFLATE_BLOCK_SIZE : SCRATCH_BUFSIZE;
+    bool last = false;
+    if (cached)
+        cached += offset;
+    else if (fseek(fd, offset, SEEK_SET) != 0)
+        return ESP_FAIL;
+    while (!last)
+    {
+        const char *in = chunk;
+        size_t chunksize;
+        if (cached)
+        {
+            /* Whole part from RAM goes as one chunk */
+            chunksize = (deflate) ? MIN(readsize, len) : len;
+            in = cached;
+            cached += chunksize;
+        }
+        else
+            /* Read file in chunks into the leased buffer */
+            chunksize = fread(chunk, 1, MIN(readsize, len), fd);
+        len -= chunksize;
+        last = (chunksize == 0 || len == 0);
+
+        const char *out = in;
+        size_t outsize = chunksize;
+        if (deflate)
+            out = (const char*) HTTPDeflateChunk(deflate, (const uint8_t*) in, chunksize, last, &outsize);
+
+        /* Send the buffer contents as HTTP response chunk */
+        if (outsize > 0 && httpd_resp_send_chunk(req, out, outsize) != ESP_OK)
+            return ESP_FAIL;
+    }
     return ESP_OK;
 }
 
@@ -254,8 +361,34 @@ esp_err_t download_get_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
 
-    fd = fopen(filepath, "r");
-    if (!fd)
+    /* Validator for If-Range, changes when file is rewritten */
+    char etag[32];
+    snprintf(etag, sizeof(etag), "\"%lx-%lx\"", (unsigned long) file_stat.st_mtime,
+             (unsigned long) file_stat.st_size);
+    httpd_resp_set_hdr(req, "Accept-Ranges", "bytes");
+
+    file_range_t ranges[HTTP_MAX_RANGES];
+    char content_range[64];
+    int nranges = parse_range_request(req, etag, file_stat.st_size, ranges);
+    if (nranges < 0)
+    {
+        snprintf(content_range, sizeof(content_range), "bytes */%ld", (long) file_stat.st_size);
+        httpd_resp_set_hdr(req, "Content-Range", content_range);
+        httpd_resp_set_status(req, "416 Range Not Satisfiable");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_FAIL;
+    }
+
+    const http_cache_entry_t *entry = NULL;
+    const char *cached = NULL;
+#if CONFIG_WEBGUIAPP_HTTP_CACHE_ENABLE
+    entry = HTTPCacheGet(filepath, (long) file_stat.st_mtime, file_stat.st_size, read_cached_file);
+    if (entry)
+        cached = entry->data;
+#endif
+    if (!cached)
+        fd = fopen(filepath, "r");
+    if (!fd && !cached)
     {
         ESP_LOGE(TAG, "Failed to read existing file : %s", filepath);
         /* Respond with 500 Internal Server Error */
@@ -263,39 +396,92 @@ esp_err_t download_get_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
 #if FILE_SERVER_DEBUG_LEVEL > 0
-    ESP_LOGI(TAG, "Sending file : %s (%ld bytes)...", filename, file_stat.st_size);
+    ESP_LOGI(TAG, "Sending file : %s (%ld bytes, %d ranges)...", filename, file_stat.st_size, nranges);
 #endif
-    set_content_type_from_file(req, filename);
-
-    /* Retrieve the pointer to scratch buffer for temporary storage */
-    char *chunk = ((struct file_server_data*) req->user_ctx)->scratch;
-    size_t chunksize;
-    do
+    const char *mime = GetMIMEType(filename);
+    http_deflate_t *deflate = NULL;
+    if (nranges == 1)
     {
-        /* Read file in chunks into the scratch buffer */
-        chunksize = fread(chunk, 1, SCRATCH_BUFSIZE, fd);
-
-        if (chunksize > 0)
+        snprintf(content_range, sizeof(content_range), "bytes %ld-%ld/%ld",
+                 ranges[0].start, ranges[0].start + ranges[0].len - 1, (long) file_stat.st_size);
+        httpd_resp_set_hdr(req, "Content-Range", content_range);
+        httpd_resp_set_status(req, "206 Partial Content");
+        httpd_resp_set_type(req, mime);
+    }
+    else if (nranges > 1)
+    {
+        httpd_resp_set_status(req, "206 Partial Content");
+        httpd_resp_set_type(req, "multipart/byteranges; boundary=" RANGE_BOUNDARY);
+    }
+    else
+    {
+        httpd_resp_set_type(req, mime);
+#if CONFIG_WEBGUIAPP_HTTP_DEFLATE_ENABLE
+        /* Compress text files on the fly if client accepts gzip, ranges
+         * always refer to the identity content */
+        if (IsCompressibleMIMEType(mime))
         {
-            /* Send the buffer contents as HTTP response chunk */
-            if (httpd_resp_send_chunk(req, chunk, chunksize) != ESP_OK)
+            httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+            if (file_stat.st_size >= CONFIG_WEBGUIAPP_HTTP_DEFLATE_MIN_SIZE &&
+                    (HTTPGetAcceptedEncodings(req) & HTTP_ENCODING_GZIP))
+                deflate = HTTPDeflateBegin();
+            if (deflate)
             {
-                fclose(fd);
-                ESP_LOGE(TAG, "File sending failed!");
-                /* Abort sending file */
-                httpd_resp_sendstr_chunk(req, NULL);
-                /* Respond with 500 Internal Server Error */
-                httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to send file");
-                return ESP_FAIL;
+                httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+                /* Strong ETag must differ for gzip content, so If-Range
+                 * with it never gets a range of identity bytes */
+                snprintf(etag, sizeof(etag), "\"%lx-%lx-gz\"", (unsigned long) file_stat.st_mtime,
+                         (unsigned long) file_stat.st_size);
             }
         }
+#endif
+    }
+    httpd_resp_set_hdr(req, "ETag", etag);
 
-        /* Keep looping till the whole file is sent */
+    /* Lease buffer for temporary storage */
+    char *chunk = HTTPBufLease();
+    if (!chunk)
+    {
+        close_file(fd, entry);
+        HTTPDeflateEnd(deflate);
+        return HTTPRespSendBusy(req);
+    }
+
+    esp_err_t res = ESP_OK;
+    if (nranges == 0)
+        res = send_file_part(req, fd, cached, chunk, 0, file_stat.st_size, deflate);
+    else if (nranges == 1)
+        res = send_file_part(req, fd, cached, chunk, ranges[0].start, ranges[0].len, NULL);
+    else
+    {
+        for (int i = 0; i < nranges && res == ESP_OK; i++)
+        {
+            /* Part header is formatted in the leased buffer and sent before file data */
+            int len = snprintf(chunk, SCRATCH_BUFSIZE,
+                               "\r\n--" RANGE_BOUNDARY "\r\nContent-Type: %s\r\nContent-Range: bytes %ld-%ld/%ld\r\n\r\n",
+                               mime, ranges[i].start, ranges[i].start + ranges[i].len - 1,
+                               (long) file_stat.st_size);
+            res = httpd_resp_send_chunk(req, chunk, len);
+            if (res == ESP_OK)
+                res = send_file_part(req, fd, cached, chunk, ranges[i].start, ranges[i].len, NULL);
+        }
+        if (res == ESP_OK)
+            res = httpd_resp_sendstr_chunk(req, "\r\n--" RANGE_BOUNDARY "--\r\n");
     }
-    while (chunksize != 0);
 
     /* Close file after sending complete */
-    fclose(fd);
+    close_file(fd, entry);
+    HTTPBufRelease(chunk);
+    HTTPDeflateEnd(deflate);
+    if (res != ESP_OK)
+    {
+        ESP_LOGE(TAG, "File sending failed!");
+        /* Abort sending file */
+        httpd_resp_sendstr_chunk(req, NULL);
+        /* Respond with 500 Internal Server Error */
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to send file");
+        return ESP_FAIL;
+    }
 #if HTTP_SERVER_DEBUG_LEVEL > 0
     ESP_LOGI(TAG, "File sending complete");
 #endif
@@ -307,6 +493,152 @@ esp_err_t download_get_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
+typedef struct
+{
+    char *data;
+    int len;        /* Negative length stops writer */
+} upload_block_t;
+
+/* Receiving task fills one buffer while writer task commits another
+ * one to the storage, so TCP window is not stalled by flash erase */
+typedef struct
+{
+    FILE *fd;
+    QueueHandle_t full;
+    QueueHandle_t empty;
+    SemaphoreHandle_t done;
+    bool write_failed;
+    int64_t write_time;
+} upload_pipe_t;
+
+static http_upload_stat_t upload_stat = { 0 };
+
+void HTTPGetUploadStat(http_upload_stat_t *stat)
+{
+    memcpy(stat, &upload_stat, sizeof(http_upload_stat_t));
+}
+
+static void UploadWriterTask(void *arg)
+{
+    upload_pipe_t *p = (upload_pipe_t*) arg;
+    upload_block_t blk;
+    while (xQueueReceive(p->full, &blk, portMAX_DELAY) == pdTRUE && blk.len >= 0)
+    {
+        if (!p->write_failed)
+        {
+            int64_t t = esp_timer_get_time();
+            if (blk.len != fwrite(blk.data, 1, blk.len, p->fd))
+                p->write_failed = true;
+            p->write_time += esp_timer_get_time() - t;
+        }
+        xQueueSend(p->empty, &blk.data, portMAX_DELAY);
+    }
+    xSemaphoreGive(p->done);
+    vTaskDelete(NULL);
+}
+
+/* Receive request body into the file through the pipeline of buffers */
+static esp_err_t receive_to_file(httpd_req_t *req, FILE *fd, const char **err)
+{
+    char *bufs[CONFIG_WEBGUIAPP_HTTP_UPLOAD_BUFFERS] = { 0 };
+    upload_pipe_t p = { .fd = fd };
+    upload_block_t blk = { 0 };
+    esp_err_t res = ESP_ERR_NO_MEM;
+    int64_t started = esp_timer_get_time();
+    int64_t blocked = 0;
+    int remaining = req->content_len;
+    int n;
+
+    p.full = xQueueCreate(CONFIG_WEBGUIAPP_HTTP_UPLOAD_BUFFERS + 1, sizeof(upload_block_t));
+    p.empty = xQueueCreate(CONFIG_WEBGUIAPP_HTTP_UPLOAD_BUFFERS, sizeof(char*));
+    p.done = xSemaphoreCreateBinary();
+    if (!p.full || !p.empty || !p.done)
+        goto cleanup;
+    for (n = 0; n < CONFIG_WEBGUIAPP_HTTP_UPLOAD_BUFFERS; n++)
+    {
+        bufs[n] = heap_caps_malloc_prefer(SCRATCH_BUFSIZE, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, MALLOC_CAP_DEFAULT);
+        if (!bufs[n])
+            goto cleanup;
+        xQueueSend(p.empty, &bufs[n], 0);
+    }
+    if (xTaskCreate(UploadWriterTask, "upload_wr", 1024 * 3, &p, 5, NULL) != pdPASS)
+        goto cleanup;
+
+    res = ESP_OK;
+    while (remaining > 0)
+    {
+        /* Wait for buffer released by writer, time here is the storage bottleneck */
+        int64_t t = esp_timer_get_time();
+        xQueueReceive(p.empty, &blk.data, portMAX_DELAY);
+        blocked += esp_timer_get_time() - t;
+
+        /* Fill whole buffer, larger writes are faster on flash */
+        blk.len = 0;
+        while (remaining > 0 && blk.len < SCRATCH_BUFSIZE)
+        {
+#if HTTP_SERVER_DEBUG_LEVEL > 0
+            ESP_LOGI(TAG, "Remaining size : %d", remaining);
+#endif
+            int received = httpd_req_recv(req, blk.data + blk.len, MIN(remaining, SCRATCH_BUFSIZE - blk.len));
+            if (received == HTTPD_SOCK_ERR_TIMEOUT)
+            {
+                /* Retry if timeout occurred */
+                continue;
+            }
+            if (received <= 0)
+            {
+                *err = "Failed to receive file";
+                res = ESP_FAIL;
+                break;
+            }
+            blk.len += received;
+            remaining -= received;
+        }
+        if (res != ESP_OK || p.write_failed)
+        {
+            xQueueSend(p.empty, &blk.data, 0);
+            break;
+        }
+        xQueueSend(p.full, &blk, portMAX_DELAY);
+    }
+
+    /* Stop writer after all blocks are committed */
+    blk.len = -1;
+    xQueueSend(p.full, &blk, portMAX_DELAY);
+    xSemaphoreTake(p.done, portMAX_DELAY);
+    if (res == ESP_OK && p.write_failed)
+    {
+        /* Couldn't write everything to file!
+         * Storage may be full? */
+        *err = "Failed to write file to storage";
+        res = ESP_FAIL;
+    }
+    if (res == ESP_OK)
+    {
+        int64_t elapsed = esp_timer_get_time() - started;
+        upload_stat.uploads++;
+        upload_stat.bytes = req->content_len;
+        upload_stat.time_ms = elapsed / 1000;
+        upload_stat.blocked_ms = blocked / 1000;
+        upload_stat.write_ms = p.write_time / 1000;
+        upload_stat.kB_per_s = (elapsed > 0) ? (uint32_t) ((int64_t) req->content_len * 1000 / elapsed) : 0;
+        ESP_LOGI(TAG, "Upload %d bytes in %u ms (%u kB/s), blocked on storage %u ms",
+                 req->content_len, (unsigned int) upload_stat.time_ms, (unsigned int) upload_stat.kB_per_s,
+                 (unsigned int) upload_stat.blocked_ms);
+    }
+
+cleanup:
+    for (n = 0; n < CONFIG_WEBGUIAPP_HTTP_UPLOAD_BUFFERS; n++)
+        free(bufs[n]);
+    if (p.full)
+        vQueueDelete(p.full);
+    if (p.empty)
+        vQueueDelete(p.empty);
+    if (p.done)
+        vSemaphoreDelete(p.done);
+    return res;
+}
+
 /* Handler to upload a file onto the server */
 esp_err_t upload_post_handler(httpd_req_t *req)
 {
@@ -363,7 +695,9 @@ esp_err_t upload_post_handler(httpd_req_t *req)
         unlink(filepath);
     }
 
-
+#if CONFIG_WEBGUIAPP_HTTP_CACHE_ENABLE
+    HTTPCacheInvalidate(filepath);
+#endif
     fd = fopen(filepath, "w");
     if (!fd)
     {
@@ -376,56 +710,20 @@ esp_err_t upload_post_handler(httpd_req_t *req)
 #if HTTP_SERVER_DEBUG_LEVEL > 0
     ESP_LOGI(TAG, "Receiving file : %s...", filename);
 #endif
-    /* Retrieve the pointer to scratch buffer for temporary storage */
-    char *buf = ((struct file_server_data*) req->user_ctx)->scratch;
-    int received;
-
-    /* Content length of the request gives
-     * the size of the file being uploaded */
-    int remaining = req->content_len;
-
-    while (remaining > 0)
+    const char *err = NULL;
+    esp_err_t res = receive_to_file(req, fd, &err);
+    if (res != ESP_OK)
     {
-#if HTTP_SERVER_DEBUG_LEVEL > 0
-        ESP_LOGI(TAG, "Remaining size : %d", remaining);
-#endif
-        /* Receive the file part by part into a buffer */
-        if ((received = httpd_req_recv(req, buf, MIN(remaining, SCRATCH_BUFSIZE))) <= 0)
-        {
-            if (received == HTTPD_SOCK_ERR_TIMEOUT)
-            {
-                /* Retry if timeout occurred */
-                continue;
-            }
-
-            /* In case of unrecoverable error,
-             * close and delete the unfinished file*/
-            fclose(fd);
-            unlink(filepath);
-
-            ESP_LOGE(TAG, "File reception failed!");
-            /* Respond with 500 Internal Server Error */
-            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to receive file");
-            return ESP_FAIL;
-        }
-
-        /* Write buffer content to file on storage */
-        if (received && (received != fwrite(buf, 1, received, fd)))
-        {
-            /* Couldn't write everything to file!
-             * Storage may be full? */
-            fclose(fd);
-            unlink(filepath);
-
-            ESP_LOGE(TAG, "File write failed!");
-            /* Respond with 500 Internal Server Error */
-            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to write file to storage");
-            return ESP_FAIL;
-        }
-
-        /* Keep track of remaining size of
-         * the file left to be uploaded */
-        remaining -= received;
+        /* In case of unrecoverable error,
+         * close and delete the unfinished file*/
+        fclose(fd);
+        unlink(filepath);
+        if (res == ESP_ERR_NO_MEM)
+            return HTTPRespSendBusy(req);
+        ESP_LOGE(TAG, "%s", err);
+        /* Respond with 500 Internal Server Error */
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, err);
+        return ESP_FAIL;
     }
 
     /* Close file upon upload completion */
@@ -481,6 +779,9 @@ esp_err_t delete_post_handler(httpd_req_t *req)
 #endif
     /* Delete file */
     unlink(filepath);
+#if CONFIG_WEBGUIAPP_HTTP_CACHE_ENABLE
+    HTTPCacheInvalidate(filepath);
+#endif
 
     /* Redirect onto root to see the updated file list */
     httpd_resp_set_status(req, "303 See Other");
@@ -23,6 +23,7 @@
 
 #include "../include/SysConfiguration.h"
 #include "NetTransport.h"
+#include "SystemApplication.h"
 #include "driver/gpio.h"
 #include "esp_event.h"
 #include "esp_log.h"
@@ -97,6 +98,9 @@ static void on_ip_event(void *arg, esp_event_base_t event_base,
            sizeof(event->ip_info.netmask));
     memcpy(&GetSysConf()->gsmSettings.Gateway, &event->ip_info.gw,
            sizeof(event->ip_info.gw));
+    ConfVarTouch("gsm_ip");
+    ConfVarTouch("gsm_mask");
+    ConfVarTouch("gsm_gw");
 #endif
 
     ESP_LOGI(TAG, "Modem Connect to PPP Server");
@@ -25,6 +25,77 @@
 #define SYS_API_VER "1.00"
 #define TAG "HTTPAPISystem"
 
+void HTTPJSONScanInit(http_json_scan_t *js)
+{
+    memset(js, 0, sizeof(http_json_scan_t));
+}
+
+/* Structure check of JSON body part by part while it is received, so
+ * malformed request is rejected without waiting for the rest of body.
+ * Brackets balance, strings, nesting depth and absence of data after
+ * the root object are verified, values are left for the parser */
+bool HTTPJSONScanFeed(http_json_scan_t *js, const char *data, size_t len)
+{
+    for (size_t i = 0; i < len && !js->error; i++)
+    {
+        char c = data[i];
+        if (js->in_string)
+        {
+            if (js->escape)
+                js->escape = false;
+            else if (c == '\\')
+                js->escape = true;
+            else if (c == '"')
+                js->in_string = false;
+            else if ((unsigned char) c < 0x20)
+                js->error = true;
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+            continue;
+        if (js->done || (js->depth == 0 && c != '{' && c != '['))
+        {
+            js->error = true;
+            continue;
+        }
+        switch (c)
+        {
+            case '{':
+            case '[':
+                if (js->depth >= HTTP_JSON_MAX_DEPTH)
+                {
+                    js->error = true;
+                    break;
+                }
+                js->brackets = (js->brackets << 1) | (c == '[');
+                js->depth++;
+            break;
+            case '}':
+            case ']':
+                if ((js->brackets & 1) != (c == ']'))
+                {
+                    js->error = true;
+                    break;
+                }
+                js->brackets >>= 1;
+                if (--js->depth == 0)
+                    js->done = true;
+            break;
+            case '"':
+                js->in_string = true;
+            break;
+            default:
+            break;
+        }
+    }
+    return !js->error;
+}
+
+bool HTTPJSONScanComplete(http_json_scan_t *js)
+{
+    return js->done && !js->error;
+}
+
 HTTP_IO_RESULT HTTPPostSysAPI(httpd_req_t *req, char *PostData)
 {
     char data[1024];
@@ -42,7 +113,6 @@ HTTP_IO_RESULT HTTPPostSysAPI(httpd_req_t *req, char *PostData)
             M.outputDataLength = EXPECTED_MAX_DATA_SIZE;
             ServiceDataHandler(&M);
             httpd_resp_set_type(req, "application/json");
-            httpd_resp_set_hdr(req, "Connection", "close");
             httpd_resp_sendstr(req, respbuf);
             free(respbuf);
             return HTTP_IO_DONE_API;
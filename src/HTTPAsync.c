@@ -0,0 +1,94 @@
+/* Copyright 2026 Bogdan Pilyugin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   File name: HTTPAsync.c
+ *     Project: webguiapp
+ *  Created on: 2026-10-17
+ *      Author: bogdan
+ * Description:	
+ */
+
+#include "HTTPServer.h"
+#include "freertos/queue.h"
+
+#define TAG "HTTPAsync"
+
+#define HTTP_ASYNC_WORKER_STACK (1024 * 6)
+
+/* Request detached from httpd task with route to execute */
+typedef struct
+{
+    httpd_req_t *req;
+    const http_route_t *route;
+} http_async_job_t;
+
+static QueueHandle_t async_queue = NULL;
+
+static void HTTPAsyncWorker(void *arg)
+{
+    http_async_job_t job;
+    while (1)
+    {
+        if (xQueueReceive(async_queue, &job, portMAX_DELAY) == pdTRUE)
+        {
+            HTTPRouteExecute(job.req, job.route);
+            httpd_req_async_handler_complete(job.req);
+        }
+    }
+}
+
+esp_err_t HTTPAsyncInit(void)
+{
+    if (async_queue)
+        return ESP_OK;
+    async_queue = xQueueCreate(CONFIG_WEBGUIAPP_HTTP_ASYNC_QUEUE_LENGTH, sizeof(http_async_job_t));
+    if (!async_queue)
+        return ESP_ERR_NO_MEM;
+    for (int i = 0; i < CONFIG_WEBGUIAPP_HTTP_ASYNC_WORKERS; i++)
+    {
+        char name[16];
+        snprintf(name, sizeof(name), "http_async%d", i);
+        if (xTaskCreate(HTTPAsyncWorker, name, HTTP_ASYNC_WORKER_STACK, NULL, 5, NULL) != pdPASS)
+        {
+            ESP_LOGE(TAG, "Failed to create async worker");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+/* Executed in httpd task, so it is free to serve other clients
+ * while the request is handled by worker */
+esp_err_t HTTPAsyncSubmit(httpd_req_t *req, const http_route_t *route)
+{
+    http_async_job_t job = { .route = route };
+    if (httpd_req_async_handler_begin(req, &job.req) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to detach request");
+        return HTTPRouteExecute(req, route);
+    }
+    if (xQueueSend(async_queue, &job, 0) != pdTRUE)
+    {
+        /* All workers are busy and queue is full */
+        httpd_req_async_handler_complete(job.req);
+        ESP_LOGW(TAG, "Async queue is full");
+        esp_err_t res = HTTPRespSendBusy(req);
+#if CONFIG_WEBGUIAPP_HTTP_RATE_LIMIT_ENABLE
+        HTTPAdmissionRelease(route);
+#endif
+        HTTPRequestComplete(req, route, res);
+        return res;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,235 @@
+/* Copyright 2026 Bogdan Pilyugin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   File name: HTTPAuth.c
+ *     Project: webguiapp
+ *  Created on: 2026-10-17
+ *      Author: bogdan
+ * Description:	
+ */
+
+#include "HTTPServer.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include <ctype.h>
+
+#define TAG "HTTPAuth"
+
+/* Cookie value is slot index followed by random token, both hex encoded,
+ * so validation is one table access and constant time token compare */
+#define SESSION_TOKEN_LENGTH    16
+#define SESSION_COOKIE_NAME     "SID"
+#define SESSION_COOKIE_LENGTH   (2 + SESSION_TOKEN_LENGTH * 2)
+#define SESSION_TIMEOUT_US      ((int64_t) CONFIG_WEBGUIAPP_HTTP_AUTH_SESSION_TIMEOUT * 1000000)
+
+typedef struct
+{
+    bool active;
+    uint8_t token[SESSION_TOKEN_LENGTH];
+    uint32_t cred;      /* Fingerprint of credentials session was issued for */
+    int64_t last_used;
+} http_session_t;
+
+static http_session_t sessions[CONFIG_WEBGUIAPP_HTTP_AUTH_SESSIONS];
+static portMUX_TYPE sessions_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Session becomes invalid if login or password changed */
+static uint32_t CredentialsFingerprint(void)
+{
+    uint32_t crc = crc32(0, (uint8_t const*) GetSysConf()->SysName, strlen(GetSysConf()->SysName));
+    return crc32(crc, (uint8_t const*) GetSysConf()->SysPass, strlen(GetSysConf()->SysPass));
+}
+
+static bool ConstTimeEqual(const uint8_t *a, const uint8_t *b, size_t len)
+{
+    uint8_t diff = 0;
+    for (size_t i = 0; i < len; i++)
+        diff |= a[i] ^ b[i];
+    return diff == 0;
+}
+
+static bool ParseHex(const char *hex, uint8_t *out, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        unsigned int b;
+        if (!isxdigit((int) hex[2 * i]) || !isxdigit((int) hex[2 * i + 1]) ||
+                sscanf(&hex[2 * i], "%2x", &b) != 1)
+            return false;
+        out[i] = b;
+    }
+    return true;
+}
+
+/* Get session slot index from cookie, -1 if session is not valid */
+static int FindSession(httpd_req_t *req)
+{
+    char cookie[SESSION_COOKIE_LENGTH + 1];
+    size_t len = sizeof(cookie);
+    uint8_t slot;
+    uint8_t token[SESSION_TOKEN_LENGTH];
+    if (httpd_req_get_cookie_val(req, SESSION_COOKIE_NAME, cookie, &len) != ESP_OK ||
+            strlen(cookie) != SESSION_COOKIE_LENGTH)
+        return -1;
+    if (!ParseHex(cookie, &slot, 1) || !ParseHex(&cookie[2], token, SESSION_TOKEN_LENGTH) ||
+            slot >= CONFIG_WEBGUIAPP_HTTP_AUTH_SESSIONS)
+        return -1;
+
+    uint32_t cred = CredentialsFingerprint();
+    int64_t now = esp_timer_get_time();
+    int res = -1;
+    portENTER_CRITICAL(&sessions_lock);
+    http_session_t *s = &sessions[slot];
+    if (s->active && ConstTimeEqual(s->token, token, SESSION_TOKEN_LENGTH))
+    {
+        if (s->cred == cred && now - s->last_used < SESSION_TIMEOUT_US)
+        {
+            s->last_used = now;
+            res = slot;
+        }
+        else
+            s->active = false;
+    }
+    portEXIT_CRITICAL(&sessions_lock);
+    return res;
+}
+
+esp_err_t HTTPAuthCheckSession(httpd_req_t *req)
+{
+    return (FindSession(req) >= 0) ? ESP_OK : ESP_FAIL;
+}
+
+/* Take free or expired slot, else evict least recently used session */
+static int NewSession(uint8_t *token)
+{
+    int64_t now = esp_timer_get_time();
+    int slot = 0;
+    esp_fill_random(token, SESSION_TOKEN_LENGTH);
+    portENTER_CRITICAL(&sessions_lock);
+    for (int i = 0; i < CONFIG_WEBGUIAPP_HTTP_AUTH_SESSIONS; i++)
+    {
+        if (!sessions[i].active || now - sessions[i].last_used >= SESSION_TIMEOUT_US)
+        {
+            slot = i;
+            break;
+        }
+        if (sessions[i].last_used < sessions[slot].last_used)
+            slot = i;
+    }
+    sessions[slot].active = true;
+    memcpy(sessions[slot].token, token, SESSION_TOKEN_LENGTH);
+    sessions[slot].cred = CredentialsFingerprint();
+    sessions[slot].last_used = now;
+    portEXIT_CRITICAL(&sessions_lock);
+    return slot;
+}
+
+/* Decode application/x-www-form-urlencoded value in place */
+static void URLDecode(char *str)
+{
+    char *out = str;
+    unsigned int c;
+    while (*str)
+    {
+        if (*str == '%' && isxdigit((int) str[1]) && isxdigit((int) str[2]) && sscanf(str + 1, "%2x", &c) == 1)
+        {
+            *out++ = c;
+            str += 3;
+        }
+        else
+        {
+            *out++ = (*str == '+') ? ' ' : *str;
+            str++;
+        }
+    }
+    *out = 0x00;
+}
+
+static bool CheckCredentials(const char *login, const char *password)
+{
+    uint8_t ref[2][32] = { 0 };
+    uint8_t inp[2][32] = { 0 };
+    strlcpy((char*) ref[0], GetSysConf()->SysName, sizeof(ref[0]));
+    strlcpy((char*) ref[1], GetSysConf()->SysPass, sizeof(ref[1]));
+    strlcpy((char*) inp[0], login, sizeof(inp[0]));
+    strlcpy((char*) inp[1], password, sizeof(inp[1]));
+    return ConstTimeEqual((uint8_t*) ref, (uint8_t*) inp, sizeof(ref)) &&
+            strlen(login) < sizeof(inp[0]) && strlen(password) < sizeof(inp[1]);
+}
+
+/* POST /login with form fields login and password, issues session cookie */
+esp_err_t HTTPAuthLoginHandler(httpd_req_t *req)
+{
+    char body[128];
+    char login[64], password[64];
+    int received, offset = 0;
+    if (req->content_len >= sizeof(body))
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Request is too large");
+        return ESP_FAIL;
+    }
+    while (offset < req->content_len)
+    {
+        received = httpd_req_recv(req, body + offset, req->content_len - offset);
+        if (received == HTTPD_SOCK_ERR_TIMEOUT)
+            continue;
+        if (received <= 0)
+            return ESP_FAIL;
+        offset += received;
+    }
+    body[offset] = 0x00;
+    if (httpd_query_key_value(body, "login", login, sizeof(login)) != ESP_OK ||
+            httpd_query_key_value(body, "password", password, sizeof(password)) != ESP_OK)
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Login and password expected");
+        return ESP_FAIL;
+    }
+    URLDecode(login);
+    URLDecode(password);
+    if (!CheckCredentials(login, password))
+    {
+        ESP_LOGW(TAG, "Login failed");
+        httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Wrong login or password");
+        return ESP_FAIL;
+    }
+
+    uint8_t token[SESSION_TOKEN_LENGTH];
+    int slot = NewSession(token);
+    char cookie[sizeof(SESSION_COOKIE_NAME) + SESSION_COOKIE_LENGTH + 64];
+    int len = snprintf(cookie, sizeof(cookie), SESSION_COOKIE_NAME "=%02x", slot);
+    for (int i = 0; i < SESSION_TOKEN_LENGTH; i++)
+        len += snprintf(cookie + len, sizeof(cookie) - len, "%02x", token[i]);
+    snprintf(cookie + len, sizeof(cookie) - len, "; Path=/; HttpOnly; SameSite=Strict; Max-Age=%d",
+             CONFIG_WEBGUIAPP_HTTP_AUTH_SESSION_TIMEOUT);
+    httpd_resp_set_hdr(req, "Set-Cookie", cookie);
+    httpd_resp_set_status(req, "204 No Content");
+    httpd_resp_send(req, NULL, 0);
+    return ESP_OK;
+}
+
+/* POST /logout drops session and expires cookie */
+esp_err_t HTTPAuthLogoutHandler(httpd_req_t *req)
+{
+    int slot = FindSession(req);
+    if (slot >= 0)
+    {
+        portENTER_CRITICAL(&sessions_lock);
+        sessions[slot].active = false;
+        portEXIT_CRITICAL(&sessions_lock);
+    }
+    httpd_resp_set_hdr(req, "Set-Cookie", SESSION_COOKIE_NAME "=; Path=/; HttpOnly; SameSite=Strict; Max-Age=0");
+    httpd_resp_set_status(req, "204 No Content");
+    httpd_resp_send(req, NULL, 0);
+    return ESP_OK;
+}
@@ -0,0 +1,182 @@
+/* Copyright 2026 Bogdan Pilyugin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   File name: HTTPBuffers.c
+ *     Project: webguiapp
+ *  Created on: 2026-10-17
+ *      Author: bogdan
+ * Description:	
+ */
+
+#include "HTTPServer.h"
+#include "freertos/semphr.h"
+
+#define TAG "HTTPBuffers"
+
+static char *pool[CONFIG_WEBGUIAPP_HTTP_BUF_POOL_SIZE];
+static uint32_t pool_busy = 0;
+static portMUX_TYPE pool_lock = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t pool_sem = NULL;
+static StaticSemaphore_t pool_sem_buf;
+static http_buf_pool_stat_t pool_stat = { 0 };
+
+esp_err_t HTTPBufPoolInit(void)
+{
+    if (pool_sem)
+        return ESP_OK;
+    for (int i = 0; i < CONFIG_WEBGUIAPP_HTTP_BUF_POOL_SIZE; i++)
+    {
+        pool[i] = malloc(SCRATCH_BUFSIZE);
+        if (!pool[i])
+        {
+            ESP_LOGE(TAG, "Failed to allocate HTTP I/O buffer %d", i);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    pool_sem = xSemaphoreCreateCountingStatic(CONFIG_WEBGUIAPP_HTTP_BUF_POOL_SIZE,
+    CONFIG_WEBGUIAPP_HTTP_BUF_POOL_SIZE,
+                                              &pool_sem_buf);
+    pool_stat.size = CONFIG_WEBGUIAPP_HTTP_BUF_POOL_SIZE;
+    return ESP_OK;
+}
+
+char* HTTPBufLease(void)
+{
+    char *buf = NULL;
+    if (!pool_sem)
+        return NULL;
+    if (xSemaphoreTake(pool_sem, 0) != pdTRUE)
+    {
+        portENTER_CRITICAL(&pool_lock);
+        pool_stat.waits++;
+        portEXIT_CRITICAL(&pool_lock);
+        if (xSemaphoreTake(pool_sem, pdMS_TO_TICKS(CONFIG_WEBGUIAPP_HTTP_BUF_LEASE_TIMEOUT)) != pdTRUE)
+        {
+            portENTER_CRITICAL(&pool_lock);
+            pool_stat.exhausted++;
+            portEXIT_CRITICAL(&pool_lock);
+            ESP_LOGW(TAG, "HTTP I/O buffers pool exhausted");
+            return NULL;
+        }
+    }
+    portENTER_CRITICAL(&pool_lock);
+    for (int i = 0; i < CONFIG_WEBGUIAPP_HTTP_BUF_POOL_SIZE; i++)
+    {
+        if (!(pool_busy & (1 << i)))
+        {
+            pool_busy |= (1 << i);
+            buf = pool[i];
+            break;
+        }
+    }
+    pool_stat.leases++;
+    if (++pool_stat.in_use > pool_stat.peak)
+        pool_stat.peak = pool_stat.in_use;
+    portEXIT_CRITICAL(&pool_lock);
+    return buf;
+}
+
+void HTTPBufRelease(char *buf)
+{
+    if (!buf)
+        return;
+    portENTER_CRITICAL(&pool_lock);
+    for (int i = 0; i < CONFIG_WEBGUIAPP_HTTP_BUF_POOL_SIZE; i++)
+    {
+        if (pool[i] == buf && (pool_busy & (1 << i)))
+        {
+            pool_busy &= ~(1 << i);
+            pool_stat.in_use--;
+            buf = NULL;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&pool_lock);
+    if (buf)
+    {
+        ESP_LOGE(TAG, "Release of buffer not leased from pool");
+        return;
+    }
+    xSemaphoreGive(pool_sem);
+}
+
+void HTTPBufPoolGetStat(http_buf_pool_stat_t *stat)
+{
+    portENTER_CRITICAL(&pool_lock);
+    memcpy(stat, &pool_stat, sizeof(http_buf_pool_stat_t));
+    portEXIT_CRITICAL(&pool_lock);
+}
+
+esp_err_t HTTPRespSendBusy(httpd_req_t *req)
+{
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    httpd_resp_set_hdr(req, "Retry-After", "1");
+    httpd_resp_set_type(req, "text/plain");
+    httpd_resp_sendstr(req, "Server is busy");
+    return ESP_FAIL;
+}
+
+/* Response writer gathers small pieces of generated content and sends
+ * them as chunks of TCP segment size instead of one chunk per piece */
+void HTTPWriterInit(http_writer_t *w, httpd_req_t *req, char *buf, size_t size)
+{
+    w->req = req;
+    w->buf = buf;
+    w->size = size;
+    w->len = 0;
+    w->err = ESP_OK;
+}
+
+esp_err_t HTTPWriterFlush(http_writer_t *w)
+{
+    if (w->err == ESP_OK && w->len > 0)
+        w->err = httpd_resp_send_chunk(w->req, w->buf, w->len);
+    w->len = 0;
+    return w->err;
+}
+
+esp_err_t HTTPWrite(http_writer_t *w, const char *data, size_t len)
+{
+    while (len > 0 && w->err == ESP_OK)
+    {
+        /* Large block goes directly without copy */
+        if (w->len == 0 && len >= w->size)
+        {
+            w->err = httpd_resp_send_chunk(w->req, data, len);
+            break;
+        }
+        size_t part = MIN(len, w->size - w->len);
+        memcpy(w->buf + w->len, data, part);
+        w->len += part;
+        data += part;
+        len -= part;
+        if (w->len == w->size)
+            HTTPWriterFlush(w);
+    }
+    return w->err;
+}
+
+esp_err_t HTTPWriteStr(http_writer_t *w, const char *str)
+{
+    return HTTPWrite(w, str, strlen(str));
+}
+
+/* Flush the rest and finish chunked response */
+esp_err_t HTTPWriterEnd(http_writer_t *w)
+{
+    HTTPWriterFlush(w);
+    if (w->err == ESP_OK)
+        w->err = httpd_resp_send_chunk(w->req, NULL, 0);
+    return w->err;
+}
@@ -0,0 +1,229 @@
+/* Copyright 2026 Bogdan Pilyugin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   File name: HTTPCache.c
+ *     Project: webguiapp
+ *  Created on: 2026-10-17
+ *      Author: bogdan
+ * Description:	
+ */
+
+#include "HTTPServer.h"
+#include "esp_heap_caps.h"
+#include "freertos/semphr.h"
+
+#define TAG "HTTPCache"
+
+/* Most requested files are kept in RAM (PSRAM if present) within the
+ * byte budget, the least recently used ones are evicted first. Entry
+ * is identified by the file path and version (mtime of storage file,
+ * 0 for espfs), entry being sent stays allocated until released */
+
+static http_cache_entry_t entries[CONFIG_WEBGUIAPP_HTTP_CACHE_ENTRIES];
+static SemaphoreHandle_t cache_mutex = NULL;
+static StaticSemaphore_t cache_mutex_buf;
+static uint32_t use_counter = 0;
+static http_cache_stat_t cache_stat = { 0 };
+
+esp_err_t HTTPCacheInit(void)
+{
+    if (!cache_mutex)
+        cache_mutex = xSemaphoreCreateMutexStatic(&cache_mutex_buf);
+    cache_stat.budget = CONFIG_WEBGUIAPP_HTTP_CACHE_SIZE * 1024;
+    return ESP_OK;
+}
+
+static void FreeEntry(http_cache_entry_t *e)
+{
+    cache_stat.bytes -= e->size;
+    cache_stat.entries--;
+    free(e->key);
+    free(e->data);
+    memset(e, 0, sizeof(http_cache_entry_t));
+}
+
+/* Entry is dropped from lookup at once and freed when not sent anymore */
+static void DropEntry(http_cache_entry_t *e)
+{
+    e->stale = true;
+    if (e->refs == 0)
+        FreeEntry(e);
+}
+
+static http_cache_entry_t* FindEntry(const char *key)
+{
+    for (int i = 0; i < CONFIG_WEBGUIAPP_HTTP_CACHE_ENTRIES; i++)
+    {
+        if (entries[i].key && !entries[i].stale && !strcmp(entries[i].key, key))
+            return &entries[i];
+    }
+    return NULL;
+}
+
+/* Bytes of entries being sent, these can't be evicted */
+static size_t PinnedBytes(void)
+{
+    size_t bytes = 0;
+    for (int i = 0; i < CONFIG_WEBGUIAPP_HTTP_CACHE_ENTRIES; i++)
+        if (entries[i].key && entries[i].refs > 0)
+            bytes += entries[i].size;
+    return bytes;
+}
+
+/* Evict LRU entries until size fits into the budget, returns free slot.
+ * Nothing is evicted if size can't fit even into empty cache */
+static http_cache_entry_t* MakeRoom(size_t size)
+{
+    if (PinnedBytes() + size > cache_stat.budget)
+        return NULL;
+    while (1)
+    {
+        http_cache_entry_t *lru = NULL;
+        http_cache_entry_t *empty = NULL;
+        for (int i = 0; i < CONFIG_WEBGUIAPP_HTTP_CACHE_ENTRIES; i++)
+        {
+            if (!entries[i].key)
+            {
+                if (!empty)
+                    empty = &entries[i];
+            }
+            else if (entries[i].refs == 0 && (!lru || entries[i].last_use < lru->last_use))
+                lru = &entries[i];
+        }
+        if (empty && cache_stat.bytes + size <= cache_stat.budget)
+            return empty;
+        if (!lru)
+            return NULL;
+        FreeEntry(lru);
+        cache_stat.evictions++;
+    }
+}
+
+/* Returns cached content of the file, reading it with fill() on miss.
+ * NULL if file is too large or memory is not available, then the
+ * caller reads the file as usual. Entry must be released after use */
+const http_cache_entry_t* HTTPCacheGet(const char *key, long version, size_t size,
+                                       bool (*fill)(const char *key, char *buf, size_t size))
+{
+    http_cache_entry_t *e;
+    if (!cache_mutex)
+        return NULL;
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    e = FindEntry(key);
+    if (e && (e->version != version || e->size != size))
+    {
+        /* File was changed bypassing the server */
+        DropEntry(e);
+        e = NULL;
+    }
+    if (e)
+    {
+        e->refs++;
+        e->last_use = ++use_counter;
+        cache_stat.hits++;
+        xSemaphoreGive(cache_mutex);
+        return e;
+    }
+    cache_stat.misses++;
+    /* Don't read the file if it can't be placed anyway */
+    bool fits = (PinnedBytes() + size <= cache_stat.budget);
+    xSemaphoreGive(cache_mutex);
+
+    if (!fits || size == 0 || size > CONFIG_WEBGUIAPP_HTTP_CACHE_MAX_FILE * 1024)
+        return NULL;
+    char *data = heap_caps_malloc_prefer(size, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, MALLOC_CAP_DEFAULT);
+    if (!data)
+        return NULL;
+    if (!fill(key, data, size))
+    {
+        free(data);
+        return NULL;
+    }
+    char *dupkey = strdup(key);
+    if (!dupkey)
+    {
+        free(data);
+        return NULL;
+    }
+
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    /* Same file could be loaded by another task meanwhile */
+    e = FindEntry(key);
+    if (!e)
+        e = MakeRoom(size);
+    else if (e->version == version && e->size == size)
+    {
+        e->refs++;
+        e->last_use = ++use_counter;
+        xSemaphoreGive(cache_mutex);
+        free(dupkey);
+        free(data);
+        return e;
+    }
+    else
+    {
+        DropEntry(e);
+        e = MakeRoom(size);
+    }
+    if (e)
+    {
+        e->key = dupkey;
+        e->data = data;
+        e->size = size;
+        e->version = version;
+        e->refs = 1;
+        e->last_use = ++use_counter;
+        cache_stat.bytes += size;
+        cache_stat.entries++;
+    }
+    xSemaphoreGive(cache_mutex);
+    if (!e)
+    {
+        free(dupkey);
+        free(data);
+    }
+    return e;
+}
+
+void HTTPCacheRelease(const http_cache_entry_t *entry)
+{
+    http_cache_entry_t *e = (http_cache_entry_t*) entry;
+    if (!e)
+        return;
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    if (--e->refs == 0 && e->stale)
+        FreeEntry(e);
+    xSemaphoreGive(cache_mutex);
+}
+
+/* Must be called when the file is rewritten or deleted */
+void HTTPCacheInvalidate(const char *key)
+{
+    if (!cache_mutex)
+        return;
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    http_cache_entry_t *e = FindEntry(key);
+    if (e)
+        DropEntry(e);
+    xSemaphoreGive(cache_mutex);
+}
+
+void HTTPCacheGetStat(http_cache_stat_t *stat)
+{
+    if (cache_mutex)
+        xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    memcpy(stat, &cache_stat, sizeof(http_cache_stat_t));
+    if (cache_mutex)
+        xSemaphoreGive(cache_mutex);
+}
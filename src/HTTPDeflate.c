@@ -0,0 +1,190 @@
+/* Copyright 2026 Bogdan Pilyugin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   File name: HTTPDeflate.c
+ *     Project: webguiapp
+ *  Created on: 2026-10-17
+ *      Author: bogdan
+ * Description:	
+ */
+
+#include "HTTPServer.h"
+
+#define TAG "HTTPDeflate"
+
+/* Minimal gzip encoder: greedy LZ77 on blocks of input with fixed Huffman
+ * codes. Compression is worse than zlib, but it needs only few kilobytes
+ * of RAM and is good enough for html, js, json and logs */
+
+#define DEFLATE_HASH_BITS   11
+#define DEFLATE_HASH_SIZE   (1 << DEFLATE_HASH_BITS)
+#define DEFLATE_MIN_MATCH   3
+#define DEFLATE_MAX_MATCH   258
+
+struct http_deflate_s
+{
+    uint16_t head[DEFLATE_HASH_SIZE];
+    uint8_t out[HTTP_DEFLATE_OUT_SIZE];
+    size_t outlen;
+    uint32_t bitbuf;
+    int bitcnt;
+    uint32_t crc;
+    uint32_t total;
+    bool started;
+};
+
+static const uint16_t LengthBase[] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t LengthExtra[] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t DistBase[] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t DistExtra[] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+static void PutBits(http_deflate_t *d, uint32_t val, int n)
+{
+    d->bitbuf |= val << d->bitcnt;
+    d->bitcnt += n;
+    while (d->bitcnt >= 8)
+    {
+        d->out[d->outlen++] = d->bitbuf & 0xff;
+        d->bitbuf >>= 8;
+        d->bitcnt -= 8;
+    }
+}
+
+/* Huffman codes are packed starting from the most significant bit */
+static void PutCode(http_deflate_t *d, uint32_t code, int n)
+{
+    uint32_t rev = 0;
+    for (int i = 0; i < n; i++)
+    {
+        rev = (rev << 1) | (code & 1);
+        code >>= 1;
+    }
+    PutBits(d, rev, n);
+}
+
+static void PutSymbol(http_deflate_t *d, int sym)
+{
+    if (sym < 144)
+        PutCode(d, 0x30 + sym, 8);
+    else if (sym < 256)
+        PutCode(d, 0x190 + sym - 144, 9);
+    else if (sym < 280)
+        PutCode(d, sym - 256, 7);
+    else
+        PutCode(d, 0xc0 + sym - 280, 8);
+}
+
+static void PutMatch(http_deflate_t *d, int len, int dist)
+{
+    int i = sizeof(LengthBase) / sizeof(LengthBase[0]) - 1;
+    while (LengthBase[i] > len)
+        i--;
+    PutSymbol(d, 257 + i);
+    PutBits(d, len - LengthBase[i], LengthExtra[i]);
+    i = sizeof(DistBase) / sizeof(DistBase[0]) - 1;
+    while (DistBase[i] > dist)
+        i--;
+    PutCode(d, i, 5);
+    PutBits(d, dist - DistBase[i], DistExtra[i]);
+}
+
+static inline uint32_t Hash3(const uint8_t *p)
+{
+    return ((p[0] << 16 | p[1] << 8 | p[2]) * 2654435761u) >> (32 - DEFLATE_HASH_BITS);
+}
+
+/* Compress one input block as a separate fixed Huffman deflate block,
+ * matches are searched inside of the block only */
+static void CompressBlock(http_deflate_t *d, const uint8_t *in, size_t len)
+{
+    size_t i = 0;
+    memset(d->head, 0, sizeof(d->head));
+    PutBits(d, 0x02, 3); // BFINAL=0, BTYPE=01 (fixed Huffman)
+    while (i + DEFLATE_MIN_MATCH <= len)
+    {
+        uint32_t h = Hash3(&in[i]);
+        int cand = (int) d->head[h] - 1;
+        d->head[h] = i + 1;
+        if (cand >= 0 && !memcmp(&in[cand], &in[i], DEFLATE_MIN_MATCH))
+        {
+            size_t ml = DEFLATE_MIN_MATCH;
+            while (i + ml < len && ml < DEFLATE_MAX_MATCH && in[cand + ml] == in[i + ml])
+                ml++;
+            PutMatch(d, ml, i - cand);
+            for (size_t k = 1; k < ml && i + k + DEFLATE_MIN_MATCH <= len; k++)
+                d->head[Hash3(&in[i + k])] = i + k + 1;
+            i += ml;
+        }
+        else
+            PutSymbol(d, in[i++]);
+    }
+    while (i < len)
+        PutSymbol(d, in[i++]);
+    PutSymbol(d, 256); // end of block
+}
+
+http_deflate_t* HTTPDeflateBegin(void)
+{
+    http_deflate_t *d = calloc(1, sizeof(http_deflate_t));
+    if (!d)
+        ESP_LOGW(TAG, "Failed to allocate deflate context");
+    return d;
+}
+
+void HTTPDeflateEnd(http_deflate_t *d)
+{
+    free(d);
+}
+
+const uint8_t* HTTPDeflateChunk(http_deflate_t *d, const uint8_t *in, size_t len, bool last, size_t *outlen)
+{
+    static const uint8_t GZIPHeader[] = { 0x1f, 0x8b, 0x08, 0, 0, 0, 0, 0, 0, 0xff };
+    d->outlen = 0;
+    if (!d->started)
+    {
+        memcpy(d->out, GZIPHeader, sizeof(GZIPHeader));
+        d->outlen = sizeof(GZIPHeader);
+        d->started = true;
+    }
+    if (len > HTTP_DEFLATE_BLOCK_SIZE)
+        len = HTTP_DEFLATE_BLOCK_SIZE;
+    if (len > 0)
+    {
+        CompressBlock(d, in, len);
+        d->crc = crc32(d->crc, in, len);
+        d->total += len;
+    }
+    if (last)
+    {
+        /* Empty final block, then align and append gzip trailer */
+        PutBits(d, 0x03, 3);
+        PutSymbol(d, 256);
+        if (d->bitcnt > 0)
+            PutBits(d, 0, 8 - d->bitcnt);
+        for (int i = 0; i < 4; i++)
+            d->out[d->outlen++] = (d->crc >> (8 * i)) & 0xff;
+        for (int i = 0; i < 4; i++)
+            d->out[d->outlen++] = (d->total >> (8 * i)) & 0xff;
+    }
+    *outlen = d->outlen;
+    return d->out;
+}
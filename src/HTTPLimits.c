@@ -0,0 +1,187 @@
+/* Copyright 2026 Bogdan Pilyugin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   File name: HTTPLimits.c
+ *     Project: webguiapp
+ *  Created on: 2026-10-17
+ *      Author: bogdan
+ * Description:	
+ */
+
+#include "HTTPServer.h"
+#include "esp_timer.h"
+#include "lwip/sockets.h"
+
+#define TAG "HTTPLimits"
+
+/* Each client address has token bucket per route class, request takes
+ * one token and tokens are refilled with configured rate up to burst.
+ * Client table is small, the least recently seen client is replaced.
+ * Besides that number of expensive requests executed at the same time
+ * is limited for all clients, so static files are served under load */
+
+#define HTTP_CLASS_STATIC       0
+#define HTTP_CLASS_EXPENSIVE    1
+#define HTTP_CLASSES            2
+
+/* Token is 1000 units, so rate in tokens/s is refill in units/ms */
+#define HTTP_TOKEN              1000
+
+typedef struct
+{
+    uint8_t addr[16];
+    int64_t last_seen;
+    int64_t refilled[HTTP_CLASSES];
+    int32_t tokens[HTTP_CLASSES];
+} http_client_bucket_t;
+
+static const int32_t class_rate[HTTP_CLASSES] = {
+        CONFIG_WEBGUIAPP_HTTP_RATE_STATIC,
+        CONFIG_WEBGUIAPP_HTTP_RATE_EXPENSIVE };
+static const int32_t class_burst[HTTP_CLASSES] = {
+        CONFIG_WEBGUIAPP_HTTP_BURST_STATIC * HTTP_TOKEN,
+        CONFIG_WEBGUIAPP_HTTP_BURST_EXPENSIVE * HTTP_TOKEN };
+
+static http_client_bucket_t clients[CONFIG_WEBGUIAPP_HTTP_RATE_CLIENTS];
+static portMUX_TYPE limits_lock = portMUX_INITIALIZER_UNLOCKED;
+static int expensive_active = 0;
+static http_limits_stat_t limits_stat = { 0 };
+
+/* Peer address as IPv6, IPv4 is stored in mapped form ::ffff:a.b.c.d */
+static bool GetPeerAddr(httpd_req_t *req, uint8_t *addr)
+{
+    struct sockaddr_storage sa;
+    socklen_t len = sizeof(sa);
+    if (getpeername(httpd_req_to_sockfd(req), (struct sockaddr*) &sa, &len) != 0)
+        return false;
+    memset(addr, 0, 16);
+    if (sa.ss_family == AF_INET)
+    {
+        addr[10] = addr[11] = 0xff;
+        memcpy(&addr[12], &((struct sockaddr_in*) &sa)->sin_addr.s_addr, 4);
+    }
+    else if (sa.ss_family == AF_INET6)
+        memcpy(addr, ((struct sockaddr_in6*) &sa)->sin6_addr.s6_addr, 16);
+    else
+        return false;
+    return true;
+}
+
+static http_client_bucket_t* GetBucket(const uint8_t *addr, int64_t now)
+{
+    http_client_bucket_t *oldest = &clients[0];
+    for (int i = 0; i < CONFIG_WEBGUIAPP_HTTP_RATE_CLIENTS; i++)
+    {
+        if (clients[i].last_seen && !memcmp(clients[i].addr, addr, 16))
+            return &clients[i];
+        if (clients[i].last_seen < oldest->last_seen)
+            oldest = &clients[i];
+    }
+    /* New client starts with full buckets */
+    memcpy(oldest->addr, addr, 16);
+    for (int c = 0; c < HTTP_CLASSES; c++)
+    {
+        oldest->tokens[c] = class_burst[c];
+        oldest->refilled[c] = now;
+    }
+    return oldest;
+}
+
+/* Returns 0 if token is taken, else seconds to wait for the next token */
+static int TakeToken(http_client_bucket_t *b, int cls, int64_t now)
+{
+    int64_t elapsed_ms = (now - b->refilled[cls]) / 1000;
+    if (elapsed_ms > 0)
+    {
+        b->tokens[cls] = MIN((int64_t) class_burst[cls], b->tokens[cls] + elapsed_ms * class_rate[cls]);
+        b->refilled[cls] += elapsed_ms * 1000;
+    }
+    b->last_seen = now;
+    if (b->tokens[cls] >= HTTP_TOKEN)
+    {
+        b->tokens[cls] -= HTTP_TOKEN;
+        return 0;
+    }
+    int wait_ms = (HTTP_TOKEN - b->tokens[cls] + class_rate[cls] - 1) / class_rate[cls];
+    return MAX(1, (wait_ms + 999) / 1000);
+}
+
+static esp_err_t SendTooMany(httpd_req_t *req, int retry_after)
+{
+    char retry[12];
+    snprintf(retry, sizeof(retry), "%d", retry_after);
+    httpd_resp_set_status(req, "429 Too Many Requests");
+    httpd_resp_set_hdr(req, "Retry-After", retry);
+    httpd_resp_set_type(req, "text/plain");
+    httpd_resp_sendstr(req, "Too many requests");
+    return ESP_FAIL;
+}
+
+/* Executed in httpd task before dispatch of the request. If request is
+ * not admitted the response is sent and ESP_FAIL returned. Admitted
+ * expensive request must be finished with HTTPAdmissionRelease() */
+esp_err_t HTTPAdmissionCheck(httpd_req_t *req, const http_route_t *route)
+{
+    uint8_t addr[16];
+    int cls = (route && (route->flags & HTTP_ROUTE_FLAG_EXPENSIVE)) ? HTTP_CLASS_EXPENSIVE : HTTP_CLASS_STATIC;
+    int wait = 0;
+    bool busy = false;
+    int64_t now = esp_timer_get_time();
+    bool known = GetPeerAddr(req, addr);
+
+    portENTER_CRITICAL(&limits_lock);
+    if (known)
+        wait = TakeToken(GetBucket(addr, now), cls, now);
+    if (wait == 0 && cls == HTTP_CLASS_EXPENSIVE)
+    {
+        if (expensive_active < CONFIG_WEBGUIAPP_HTTP_MAX_EXPENSIVE)
+            expensive_active++;
+        else
+            busy = true;
+    }
+    if (wait)
+        limits_stat.limited++;
+    else if (busy)
+        limits_stat.busy++;
+    portEXIT_CRITICAL(&limits_lock);
+
+    if (wait)
+    {
+#if HTTP_SERVER_DEBUG_LEVEL > 0
+        ESP_LOGW(TAG, "Rate limit of %s, retry after %d s", req->uri, wait);
+#endif
+        return SendTooMany(req, wait);
+    }
+    if (busy)
+        return HTTPRespSendBusy(req);
+    return ESP_OK;
+}
+
+void HTTPAdmissionRelease(const http_route_t *route)
+{
+    if (!route || !(route->flags & HTTP_ROUTE_FLAG_EXPENSIVE))
+        return;
+    portENTER_CRITICAL(&limits_lock);
+    if (expensive_active > 0)
+        expensive_active--;
+    portEXIT_CRITICAL(&limits_lock);
+}
+
+void HTTPGetLimitsStat(http_limits_stat_t *stat)
+{
+    portENTER_CRITICAL(&limits_lock);
+    memcpy(stat, &limits_stat, sizeof(http_limits_stat_t));
+    stat->expensive_active = expensive_active;
+    portEXIT_CRITICAL(&limits_lock);
+}
@@ -0,0 +1,134 @@
+/* Copyright 2026 Bogdan Pilyugin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   File name: HTTPMetrics.c
+ *     Project: webguiapp
+ *  Created on: 2026-10-17
+ *      Author: bogdan
+ * Description:	
+ */
+
+#include "HTTPServer.h"
+
+#define TAG "HTTPMetrics"
+
+/* Statistics are accumulated per route, requests matching no route go
+ * to the last slot. Latency is measured from dispatch of the request
+ * to the end of handler, so it includes waiting for async worker */
+
+#define HTTP_METRICS_BUCKETS 8
+
+/* Upper bounds of latency histogram buckets in ms, last one is unbounded.
+ * Must be in sync with "buckets_ms" of HTTPMetricsPrint() */
+static const uint32_t bucket_bounds_ms[HTTP_METRICS_BUCKETS - 1] = { 1, 5, 20, 100, 500, 2000, 10000 };
+
+typedef struct
+{
+    const http_route_t *route;
+    uint32_t requests;
+    uint32_t errors;
+    uint32_t status[4]; /* 2xx, 3xx, 4xx, 5xx */
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    uint64_t time_us;
+    uint32_t max_us;
+    uint32_t hist[HTTP_METRICS_BUCKETS];
+} http_route_stat_t;
+
+static http_route_stat_t stats[CONFIG_WEBGUIAPP_HTTP_MAX_ROUTES + 1];
+static portMUX_TYPE metrics_lock = portMUX_INITIALIZER_UNLOCKED;
+static int connections = 0;
+static int connections_peak = 0;
+static int active = 0;
+static int active_peak = 0;
+
+void HTTPMetricsConnection(bool open)
+{
+    portENTER_CRITICAL(&metrics_lock);
+    if (open)
+        connections_peak = MAX(connections_peak, ++connections);
+    else
+        connections--;
+    portEXIT_CRITICAL(&metrics_lock);
+}
+
+void HTTPMetricsBegin(void)
+{
+    portENTER_CRITICAL(&metrics_lock);
+    active_peak = MAX(active_peak, ++active);
+    portEXIT_CRITICAL(&metrics_lock);
+}
+
+void HTTPMetricsRecord(const http_route_t *route, int status, size_t in, size_t out, int64_t us, bool failed)
+{
+    int b;
+    http_route_stat_t *st = &stats[(route) ? route->id : CONFIG_WEBGUIAPP_HTTP_MAX_ROUTES];
+    uint32_t ms = us / 1000;
+    for (b = 0; b < HTTP_METRICS_BUCKETS - 1 && ms >= bucket_bounds_ms[b]; b++)
+        ;
+    portENTER_CRITICAL(&metrics_lock);
+    active--;
+    st->route = route;
+    st->requests++;
+    if (failed || status == 0)
+        st->errors++;
+    if (status >= 200 && status < 600)
+        st->status[status / 100 - 2]++;
+    st->bytes_in += in;
+    st->bytes_out += out;
+    st->time_us += us;
+    st->max_us = MAX(st->max_us, (uint32_t) us);
+    st->hist[b]++;
+    portEXIT_CRITICAL(&metrics_lock);
+}
+
+/* JSON object with connections counters and array of routes served at
+ * least once, routes not fitting into the buffer are omitted */
+void HTTPMetricsPrint(char *buf, size_t size)
+{
+    http_route_stat_t st;
+    char item[384];
+    int len = snprintf(buf, size, "{\"conn\":%d,\"conn_peak\":%d,\"active\":%d,\"active_peak\":%d,"
+                       "\"buckets_ms\":[1,5,20,100,500,2000,10000],\"routes\":[",
+                       connections, connections_peak, active, active_peak);
+    for (int i = 0; i <= CONFIG_WEBGUIAPP_HTTP_MAX_ROUTES; i++)
+    {
+        portENTER_CRITICAL(&metrics_lock);
+        memcpy(&st, &stats[i], sizeof(st));
+        portEXIT_CRITICAL(&metrics_lock);
+        if (st.requests == 0)
+            continue;
+        int n = snprintf(item, sizeof(item),
+                         "{\"uri\":\"%s\",\"method\":\"%s\",\"n\":%u,\"err\":%u,"
+                         "\"2xx\":%u,\"3xx\":%u,\"4xx\":%u,\"5xx\":%u,\"in\":%llu,\"out\":%llu,"
+                         "\"avg_us\":%u,\"max_us\":%u,\"hist\":[%u,%u,%u,%u,%u,%u,%u,%u]}",
+                         (st.route) ? st.route->uri : "*",
+                         (st.route) ? http_method_str(st.route->method) : "*",
+                         (unsigned int) st.requests, (unsigned int) st.errors,
+                         (unsigned int) st.status[0], (unsigned int) st.status[1],
+                         (unsigned int) st.status[2], (unsigned int) st.status[3],
+                         (unsigned long long) st.bytes_in, (unsigned long long) st.bytes_out,
+                         (unsigned int) (st.time_us / st.requests), (unsigned int) st.max_us,
+                         (unsigned int) st.hist[0], (unsigned int) st.hist[1], (unsigned int) st.hist[2],
+                         (unsigned int) st.hist[3], (unsigned int) st.hist[4], (unsigned int) st.hist[5],
+                         (unsigned int) st.hist[6], (unsigned int) st.hist[7]);
+        if (n >= sizeof(item) || len + n + 4 > size)
+            break;
+        if (buf[len - 1] == '}')
+            buf[len++] = ',';
+        memcpy(buf + len, item, n + 1);
+        len += n;
+    }
+    strcpy(buf + len, "]}");
+}
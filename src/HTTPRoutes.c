@@ -0,0 +1,125 @@
+/* Copyright 2026 Bogdan Pilyugin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   File name: HTTPRoutes.c
+ *     Project: webguiapp
+ *  Created on: 2026-10-17
+ *      Author: bogdan
+ * Description:	
+ */
+
+#include "HTTPServer.h"
+
+#define TAG "HTTPRoutes"
+
+/* Routes are kept in open addressing hash table keyed by method, match
+ * type and URI. Request is resolved with one probe for exact match and
+ * one probe per path segment for prefix match, longest prefix wins.
+ * So dispatch cost does not depend on number of registered routes */
+
+#define HTTP_ROUTES_HASH_SIZE   64
+
+_Static_assert(HTTP_ROUTES_HASH_SIZE >= CONFIG_WEBGUIAPP_HTTP_MAX_ROUTES * 2, "Routes hash table too small");
+
+static http_route_t routes[HTTP_ROUTES_HASH_SIZE];
+static int routes_num = 0;
+
+static uint32_t RouteHash(httpd_method_t method, http_route_match_t match, const char *uri, size_t len)
+{
+    uint32_t h = 2166136261u;
+    h = (h ^ (uint8_t) method) * 16777619u;
+    h = (h ^ (uint8_t) match) * 16777619u;
+    for (size_t i = 0; i < len; i++)
+        h = (h ^ (uint8_t) uri[i]) * 16777619u;
+    return h;
+}
+
+static http_route_t* RouteSlot(httpd_method_t method, http_route_match_t match, const char *uri, size_t len,
+                               bool *found)
+{
+    uint32_t idx = RouteHash(method, match, uri, len) & (HTTP_ROUTES_HASH_SIZE - 1);
+    for (int i = 0; i < HTTP_ROUTES_HASH_SIZE; i++)
+    {
+        http_route_t *r = &routes[(idx + i) & (HTTP_ROUTES_HASH_SIZE - 1)];
+        if (!r->handler)
+        {
+            *found = false;
+            return r;
+        }
+        if (r->method == method && r->match == match && r->urilen == len && !memcmp(r->uri, uri, len))
+        {
+            *found = true;
+            return r;
+        }
+    }
+    *found = false;
+    return NULL;
+}
+
+esp_err_t HTTPRouteRegister(const char *uri, httpd_method_t method, http_route_match_t match, int flags,
+                            esp_err_t (*handler)(httpd_req_t *req))
+{
+    bool found;
+    if (!uri || !handler)
+        return ESP_ERR_INVALID_ARG;
+    size_t len = strlen(uri);
+    http_route_t *r = RouteSlot(method, match, uri, len, &found);
+    if (found)
+    {
+        /* Route registered first wins, so user routes registered before
+         * server start take precedence over system ones */
+        ESP_LOGW(TAG, "Route %s already registered", uri);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!r || routes_num >= CONFIG_WEBGUIAPP_HTTP_MAX_ROUTES)
+    {
+        ESP_LOGE(TAG, "No room for route %s", uri);
+        return ESP_ERR_NO_MEM;
+    }
+    r->id = routes_num;
+    r->uri = uri;
+    r->urilen = len;
+    r->method = method;
+    r->match = match;
+    r->flags = flags;
+    r->handler = handler;
+    routes_num++;
+    return ESP_OK;
+}
+
+static const http_route_t* RouteLookup(httpd_method_t method, http_route_match_t match, const char *uri, size_t len)
+{
+    bool found;
+    const http_route_t *r = RouteSlot(method, match, uri, len, &found);
+    return (found) ? r : NULL;
+}
+
+/* Prefix "/app" matches "/app" and "/app/x" but not "/application",
+ * prefix "/app/" matches "/app/" and "/app/x" */
+const http_route_t* HTTPRouteFind(httpd_method_t method, const char *uri)
+{
+    const http_route_t *r;
+    size_t len = strcspn(uri, "?#");
+    if ((r = RouteLookup(method, HTTP_ROUTE_EXACT, uri, len)))
+        return r;
+    for (size_t l = len; l > 0; l--)
+    {
+        if (l == len || uri[l] == '/' || uri[l - 1] == '/')
+        {
+            if ((r = RouteLookup(method, HTTP_ROUTE_PREFIX, uri, l)))
+                return r;
+        }
+    }
+    return NULL;
+}
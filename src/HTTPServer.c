@@ -23,11 +23,14 @@
 
 #include "HTTPServer.h"
 #include "sdkconfig.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "lwip/sockets.h"
+#include <ctype.h>
+#include "jWrite.h"
 
 extern espfs_fs_t *fs;
 
-const char GZIP_SIGN[] = { 0x1f, 0x8b, 0x08 };
-
 static esp_err_t GETHandler(httpd_req_t *req);
 static esp_err_t CheckAuth(httpd_req_t *req);
 
@@ -36,6 +39,28 @@ httpd_handle_t server = NULL;
 static const char *TAG = "HTTPServer";
 
 const char url_api[] = "/api";
+
+#define HTTP_STR_HELPER(x) #x
+#define HTTP_STR(x) HTTP_STR_HELPER(x)
+
+/* Per connection state, lives while the client socket is open */
+typedef struct
+{
+    int requests;
+    int64_t last_activity;
+    bool busy;
+    bool close_after;
+#if CONFIG_WEBGUIAPP_HTTP_METRICS_ENABLE
+    int fd;
+    int64_t req_start; /* Request is metered while not 0 */
+    int status;
+    size_t bytes_out;
+#endif
+} http_sess_ctx_t;
+
+#if CONFIG_WEBGUIAPP_HTTP_KEEPALIVE_ENABLE
+static esp_timer_handle_t idle_timer = NULL;
+#endif
 //Pointer to external user defined rest api handler
 static int (*HTTPUserRestAPI)(char *url, char *req, int len, char *resp) = NULL;
 void regHTTPUserRestAPI(int (*api_handler)(char *url, char *req, int len, char *resp))
@@ -43,18 +68,23 @@ void regHTTPUserRestAPI(int (*api_handler)(char *url, char *req, int len, char *
     HTTPUserRestAPI = api_handler;
 }
 
-char *userappurl = NULL;
-static esp_err_t (*HTTPUserAppGETHandler)(httpd_req_t *req) = NULL;
-static esp_err_t (*HTTPUserAppPOSTHandler)(httpd_req_t *req) = NULL;
-
 void regHTTPUserAppHandlers(char *url,
                             esp_err_t (*get)(httpd_req_t *req),
                             esp_err_t (*post)(httpd_req_t *req))
 {
-    userappurl = url;
-    HTTPUserAppGETHandler = get;
-    HTTPUserAppPOSTHandler = post;
+    if (get)
+        HTTPRouteRegister(url, HTTP_GET, HTTP_ROUTE_PREFIX, 0, get);
+    if (post)
+        HTTPRouteRegister(url, HTTP_POST, HTTP_ROUTE_PREFIX, 0, post);
+}
 
+esp_err_t regHTTPUserRoute(const char *uri,
+                           httpd_method_t method,
+                           http_route_match_t match,
+                           int flags,
+                           esp_err_t (*handler)(httpd_req_t *req))
+{
+    return HTTPRouteRegister(uri, method, match, flags, handler);
 }
 
 #define BASIC_LOGIN_LENGTH 31
@@ -62,18 +92,18 @@ void regHTTPUserAppHandlers(char *url,
 #define BASIC_DECODED_LENGTH (BASIC_LOGIN_LENGTH + BASIC_PASS_LENGTH + 1 + 1)
 #define BASIC_ENCODED_LENGTH (BASIC_DECODED_LENGTH * 4 / 3)
 
-static esp_err_t CheckAuth(httpd_req_t *req)
+/* Check session cookie or Basic credentials, no response is sent */
+bool HTTPIsAuthorized(httpd_req_t *req)
 {
     unsigned char pass[BASIC_DECODED_LENGTH] = { 0 }; //max length of login:password decoded string
     unsigned char inp[BASIC_ENCODED_LENGTH];  //max length of login:password coded string plus Basic
     const char keyword1[] = "Basic ";
     const int keyword1len = sizeof(keyword1) - 1;
+    /* Valid session cookie, no need to decode credentials */
+    if (HTTPAuthCheckSession(req) == ESP_OK)
+        return true;
     if (httpd_req_get_hdr_value_len(req, "Authorization") > BASIC_ENCODED_LENGTH)
-    {
-        httpd_resp_set_hdr(req, "Connection", "close");
-        httpd_resp_send_err(req, HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE, "Authorization field value is too large");
-        return ESP_FAIL;
-    }
+        return false;
     httpd_req_get_hdr_value_str(req, "Authorization", (char*) inp, BASIC_ENCODED_LENGTH);
     unsigned char *pt = memmem(inp, sizeof(inp), keyword1, keyword1len);
     if (pt)
@@ -95,70 +125,155 @@ static esp_err_t CheckAuth(httpd_req_t *req)
         ESP_LOGI(TAG, "Reference auth data is %s", inp);
 #endif
     }
-    if (pt == NULL || strcmp((const char*) inp, (char*) pass))
+    return (pt != NULL && !strcmp((const char*) inp, (char*) pass));
+}
+
+static esp_err_t CheckAuth(httpd_req_t *req)
+{
+    if (HTTPIsAuthorized(req))
+        return ESP_OK;
+    if (httpd_req_get_hdr_value_len(req, "Authorization") > BASIC_ENCODED_LENGTH)
     {
-        httpd_resp_set_hdr(req, "WWW-Authenticate", "Basic");
-        //httpd_resp_set_hdr(req, "Connection", "keep-alive");
-        httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "This page requires authorization");
+        httpd_resp_set_hdr(req, "Connection", "close");
+        httpd_resp_send_err(req, HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE, "Authorization field value is too large");
         return ESP_FAIL;
     }
-    return ESP_OK;
+    httpd_resp_set_hdr(req, "WWW-Authenticate", "Basic");
+    //httpd_resp_set_hdr(req, "Connection", "keep-alive");
+    httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "This page requires authorization");
+    return ESP_FAIL;
 }
 
-#define IS_FILE_EXT(filename, ext) \
-    (strcasecmp(&filename[strlen(filename) - sizeof(ext) + 1], ext) == 0)
+typedef struct
+{
+    const char *ext;
+    const char *type;
+} mime_type_t;
+
+/* This is a limited set only */
+static const mime_type_t MIMETypes[] = {
+        { "html", "text/html" },
+        { "js", "text/javascript" },
+        { "css", "text/css" },
+        { "json", "application/json" },
+        { "png", "image/png" },
+        { "jpeg", "image/jpeg" },
+        { "jpg", "image/jpeg" },
+        { "svg", "image/svg+xml" },
+        { "ico", "image/x-icon" },
+        { "woff", "font/woff" },
+        { "woff2", "font/woff2" },
+        { "pdf", "application/pdf" },
+};
 
-/* Set HTTP response content type according to file extension */
-static esp_err_t set_content_type_from_file(httpd_req_t *req,
-                                            const char *filename)
+/* Get MIME type according to file extension */
+const char* GetMIMEType(const char *filename)
 {
-    if (IS_FILE_EXT(filename, ".pdf"))
-    {
-        return httpd_resp_set_type(req, "application/pdf");
-    }
-    else if (IS_FILE_EXT(filename, ".html"))
-    {
-        return httpd_resp_set_type(req, "text/html");
-    }
-    else if (IS_FILE_EXT(filename, ".jpeg"))
-    {
-        return httpd_resp_set_type(req, "image/jpeg");
-    }
-    else if (IS_FILE_EXT(filename, ".png"))
-    {
-        return httpd_resp_set_type(req, "image/png");
-    }
-    else if (IS_FILE_EXT(filename, ".ico"))
-    {
-        return httpd_resp_set_type(req, "image/x-icon");
-    }
-    else if (IS_FILE_EXT(filename, ".svg"))
+    const char *ext = strrchr(filename, '.');
+    if (ext && !strchr(ext, '/'))
     {
-        return httpd_resp_set_type(req, "image/svg+xml");
+        ext++;
+        for (int i = 0; i < sizeof(MIMETypes) / sizeof(mime_type_t); i++)
+            if (!strcasecmp(ext, MIMETypes[i].ext))
+                return MIMETypes[i].type;
     }
-    else if (IS_FILE_EXT(filename, ".css"))
-    {
-        return httpd_resp_set_type(req, "text/css");
-    }
-    else if (IS_FILE_EXT(filename, ".js"))
-    {
-        return httpd_resp_set_type(req, "text/javascript");
-    }
-    else if (IS_FILE_EXT(filename, ".woff"))
-    {
-        return httpd_resp_set_type(req, "font/woff");
-    }
-    else if (IS_FILE_EXT(filename, ".woff2"))
+    /* For any other type always set as plain text */
+    return "text/plain";
+}
+
+/* Text content worth compressing on the fly */
+bool IsCompressibleMIMEType(const char *mime)
+{
+    return (!strncmp(mime, "text/", 5) ||
+            !strcmp(mime, "application/json") ||
+            !strcmp(mime, "image/svg+xml"));
+}
+
+/* Parse Accept-Encoding header, codings with q=0 are refused */
+int HTTPGetAcceptedEncodings(httpd_req_t *req)
+{
+    char hdr[128];
+    char *save, *tok;
+    int accepted = 0;
+    esp_err_t res = httpd_req_get_hdr_value_str(req, "Accept-Encoding", hdr, sizeof(hdr));
+    if (res != ESP_OK && res != ESP_ERR_HTTPD_RESULT_TRUNC)
+        return 0;
+    for (tok = strtok_r(hdr, ",", &save); tok; tok = strtok_r(NULL, ",", &save))
     {
-        return httpd_resp_set_type(req, "font/woff2");
+        int enc = 0;
+        bool refused = false;
+        char *par = strchr(tok, ';');
+        if (par)
+        {
+            *par++ = 0x00;
+            char *q = strstr(par, "q=");
+            refused = (q && atof(q + 2) == 0);
+        }
+        while (*tok == ' ')
+            tok++;
+        for (char *end = tok + strlen(tok); end > tok && end[-1] == ' '; end--)
+            end[-1] = 0x00;
+        if (!strcasecmp(tok, "gzip"))
+            enc = HTTP_ENCODING_GZIP;
+        else if (!strcasecmp(tok, "br"))
+            enc = HTTP_ENCODING_BR;
+        else if (!strcmp(tok, "*"))
+            enc = HTTP_ENCODING_GZIP | HTTP_ENCODING_BR;
+        if (refused)
+            accepted &= ~enc;
+        else
+            accepted |= enc;
     }
-    else if (IS_FILE_EXT(filename, ".json"))
+    return accepted;
+}
+
+/* Pick the smallest stored representation acceptable by the client */
+static const romfs_asset_t* SelectAssetVariant(const romfs_asset_t *asset, int accepted)
+{
+    if (asset->br && (accepted & HTTP_ENCODING_BR))
+        return asset->br;
+    if (asset->gz && (accepted & HTTP_ENCODING_GZIP))
+        return asset->gz;
+    return asset;
+}
+
+/* Asset name contains content hash like app.3f2a9c1b.js or app-3f2a9c1b.js */
+static bool IsHashedAssetName(const char *filename)
+{
+    const char *name = strrchr(filename, '/');
+    name = (name) ? name + 1 : filename;
+    int hexlen = 0;
+    for (const char *p = name; *p; p++)
     {
-        return httpd_resp_set_type(req, "application/json");
+        if (isxdigit((unsigned char) *p))
+            hexlen++;
+        else if (*p == '.' || *p == '-')
+        {
+            if (hexlen >= 8 && p != name + hexlen)
+                return true;
+            hexlen = 0;
+        }
+        else
+            hexlen = -1024;
     }
-    /* This is a limited set only */
-    /* For any other type always set as plain text */
-    return httpd_resp_set_type(req, "text/plain");
+    return false;
+}
+
+#define IF_NONE_MATCH_MAX_LENGTH 256
+#define API_VARS_QUERY_MAX_LENGTH 512
+
+/* Weak comparison of If-None-Match header against the entity tag */
+static bool IsETagMatched(httpd_req_t *req, const char *etag)
+{
+    char inm[IF_NONE_MATCH_MAX_LENGTH];
+    size_t len = httpd_req_get_hdr_value_len(req, "If-None-Match");
+    if (len == 0 || len >= sizeof(inm))
+        return false;
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", inm, sizeof(inm)) != ESP_OK)
+        return false;
+    if (!strcmp(inm, "*"))
+        return true;
+    return (strstr(inm, etag) != NULL);
 }
 
 /* Copies the full path into destination buffer and returns
@@ -195,37 +310,59 @@ static const char* get_path_from_uri(char *dest, const char *base_path,
     return dest + base_pathlen;
 }
 
-static esp_err_t POSTHandler(httpd_req_t *req)
+static void HTTPSessionCloseAfter(httpd_req_t *req);
+
+static void SysAPIBodyRelease(char *buf, bool pooled)
+{
+    if (pooled)
+        HTTPBufRelease(buf);
+    else
+        free(buf);
+}
+
+static esp_err_t SysAPIPOSTHandler(httpd_req_t *req)
 {
 #if HTTP_SERVER_DEBUG_LEVEL > 0
-    ESP_LOGI(TAG, "POST request handle URL: %s", req->uri);
+    ESP_LOGI(TAG, "API request handle URL: %s", req->uri);
 #endif
 
-    if(userappurl && HTTPUserAppPOSTHandler)
+    if (CheckAuth(req) != ESP_OK)
+        return ESP_FAIL;
+
+    if (req->content_len > CONFIG_WEBGUIAPP_HTTP_API_MAX_BODY)
     {
-        if (memmem(req->uri, strlen(req->uri), userappurl, strlen(userappurl)))
-            return HTTPUserAppPOSTHandler(req);
+        /* Do not drain the body, just close connection after response */
+        HTTPSessionCloseAfter(req);
+        httpd_resp_set_status(req, "413 Payload Too Large");
+        httpd_resp_sendstr(req, "Request is too large");
+        return ESP_FAIL;
     }
 
-    if (memmem(req->uri, strlen(req->uri), "/storage/upload/", sizeof("/storage/upload/") - 1))
-        return upload_post_handler(req);
-    if (memmem(req->uri, strlen(req->uri), "/storage/delete/", sizeof("/storage/delete/") - 1))
-        return delete_post_handler(req);
+    /* Body fitting into I/O buffer uses the pool, larger one is placed
+     * into the heap (PSRAM if available) because parser needs it as
+     * one string */
+    bool pooled = (req->content_len < SCRATCH_BUFSIZE);
+    char *buf;
+    if (pooled)
+        buf = HTTPBufLease();
+    else
+        buf = heap_caps_malloc_prefer(req->content_len + 1, 2,
+                                      MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
+                                      MALLOC_CAP_DEFAULT);
+    if (!buf)
+        return HTTPRespSendBusy(req);
 
-    char *buf = ((struct file_server_data*) req->user_ctx)->scratch;
+    http_json_scan_t js;
+    HTTPJSONScanInit(&js);
     int received;
     int offset = 0;
     int remaining = req->content_len;
-    buf[req->content_len] = 0x00;
     while (remaining > 0)
     {
 #if HTTP_SERVER_DEBUG_LEVEL > 0
         ESP_LOGI(TAG, "Remaining size : %d", remaining);
 #endif
-        /* Receive the file part by part into a buffer */
-
-        if ((received = httpd_req_recv(req, buf + offset,
-                                       MIN(remaining, SCRATCH_BUFSIZE))) <= 0)
+        if ((received = httpd_req_recv(req, buf + offset, remaining)) <= 0)
         {
             if (received == HTTPD_SOCK_ERR_TIMEOUT)
             {
@@ -234,68 +371,236 @@ static esp_err_t POSTHandler(httpd_req_t *req)
             }
 
             /* In case of unrecoverable error*/
-            ESP_LOGE(TAG, "File reception failed!");
+            SysAPIBodyRelease(buf, pooled);
+            ESP_LOGE(TAG, "Request reception failed!");
             /* Respond with 500 Internal Server Error */
             httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
-                                "Failed to receive file");
+                                "Failed to receive request");
             return ESP_FAIL;
         }
 
-        /* Write buffer content to file on storage */
-        if (received)
-            offset += received;
+        /* Check the part just received, don't wait for the rest of malformed body */
+        if (!HTTPJSONScanFeed(&js, buf + offset, received))
+            break;
+        offset += received;
+        remaining -= received;
+    }
+    buf[offset] = 0x00;
+
+    if (!HTTPJSONScanComplete(&js))
+    {
+        SysAPIBodyRelease(buf, pooled);
+        if (remaining > 0)
+            HTTPSessionCloseAfter(req);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Malformed JSON");
+        return ESP_FAIL;
+    }
+
+    HTTPPostSysAPI(req, buf);
+    SysAPIBodyRelease(buf, pooled);
+    return ESP_OK;
+}
+
+/* Decode commas escaped by the client, names contain no other special characters */
+static void UnescapeCommas(char *str)
+{
+    char *out = str;
+    while (*str)
+    {
+        if (str[0] == '%' && str[1] == '2' && (str[2] == 'C' || str[2] == 'c'))
         {
-#if HTTP_SERVER_DEBUG_LEVEL > 0
-        ESP_LOGI(TAG, "Received : %d", received);
-#endif
+            *out++ = ',';
+            str += 3;
         }
+        else
+            *out++ = *str++;
+    }
+    *out = 0x00;
+}
 
-        /* Keep track of remaining size of
-         * the file left to be uploaded */
-        remaining -= received;
+/* GET /api/vars?names=a,b,c returns {"a":1,"b":"str","c":null} without
+ * the signed data envelope, unknown variables are null. Response is built
+ * in one buffer to get ETag, if it doesn't fit there it is streamed
+ * in chunks without ETag */
+typedef struct
+{
+    struct jWriteControl *jwc;
+    http_writer_t *w;
+    char *value;
+    int count;
+} api_vars_ctx_t;
+
+static void WriteJSONString(http_writer_t *w, const char *str)
+{
+    char esc[8];
+    const char *run = str;
+    HTTPWrite(w, "\"", 1);
+    for (; *str; str++)
+    {
+        unsigned char c = (unsigned char) *str;
+        if (c != '"' && c != '\\' && c >= 0x20)
+            continue;
+        HTTPWrite(w, run, str - run);
+        if (c == '"' || c == '\\')
+            snprintf(esc, sizeof(esc), "\\%c", c);
+        else
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+        HTTPWriteStr(w, esc);
+        run = str + 1;
     }
+    HTTPWrite(w, run, str - run);
+    HTTPWrite(w, "\"", 1);
+}
 
-    char filepath[FILE_PATH_MAX];
-    const char *filename;
+static void WriteAPIVar(char *name, void *arg)
+{
+    api_vars_ctx_t *ctx = (api_vars_ctx_t*) arg;
+    rest_var_types tp;
+    ctx->value[0] = 0x00;
+    bool found = (IsConfVarReadSafe(name) && GetConfVar(name, ctx->value, &tp) == ESP_OK);
+    bool str = (found && (tp == VAR_STRING || tp == VAR_IPADDR || tp == VAR_ERROR));
+    if (ctx->w)
+    {
+        if (ctx->count++)
+            HTTPWrite(ctx->w, ",", 1);
+        WriteJSONString(ctx->w, name);
+        HTTPWrite(ctx->w, ":", 1);
+        if (!found)
+            HTTPWriteStr(ctx->w, "null");
+        else if (str)
+            WriteJSONString(ctx->w, ctx->value);
+        else
+            HTTPWriteStr(ctx->w, ctx->value);
+    }
+    else if (!found)
+        jwObj_null(ctx->jwc, name);
+    else if (str)
+        jwObj_string(ctx->jwc, name, ctx->value);
+    else
+        jwObj_raw(ctx->jwc, name, ctx->value);
+}
+
+/* Walk comma separated names without changing them, so it can be done twice */
+static void ForEachAPIVar(const char *names, uint32_t since, api_vars_ctx_t *ctx)
+{
+    char name[VAR_MAX_NAME_LENGTH];
+    while (*names)
+    {
+        const char *end = strchr(names, ',');
+        if (!end)
+            end = names + strlen(names);
+        size_t len = end - names;
+        if (len > 0 && len < sizeof(name))
+        {
+            memcpy(name, names, len);
+            name[len] = 0x00;
+            if (strchr(name, '*'))
+                ConfVarsForEach(name, since, WriteAPIVar, ctx);
+            else if (IsConfVarChangedSince(name, since))
+                WriteAPIVar(name, ctx);
+        }
+        names = (*end) ? end + 1 : end;
+    }
+}
+
+static esp_err_t SysAPIVarsGETHandler(httpd_req_t *req)
+{
+    char query[API_VARS_QUERY_MAX_LENGTH];
+    char names[API_VARS_QUERY_MAX_LENGTH];
+    char etag[16];
+    char param[12];
+    char generation[12];
+    uint32_t since = 0;
+    struct jWriteControl jwc;
 
     if (CheckAuth(req) != ESP_OK)
         return ESP_FAIL;
 
-    filename = get_path_from_uri(filepath,
-                                 ((struct file_server_data*) req->user_ctx)->base_path,
-                                 req->uri,
-                                 sizeof(filepath));
-
-    if (!memcmp(filename, url_api, sizeof(url_api)))
-        HTTPPostSysAPI(req, buf);
-    else
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+            httpd_query_key_value(query, "names", names, sizeof(names)) != ESP_OK)
     {
-        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "URL not found");
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Parameter 'names' expected");
         return ESP_FAIL;
     }
+    UnescapeCommas(names);
+    /* With since only variables changed after that generation are sent,
+     * function variables are live and always sent. The current generation
+     * is returned for the next request */
+    if (httpd_query_key_value(query, "since", param, sizeof(param)) == ESP_OK)
+        since = strtoul(param, NULL, 10);
+    snprintf(generation, sizeof(generation), "%lu", (unsigned long) GetConfVarsGeneration());
+
+    char *value = HTTPBufLease();
+    if (!value)
+        return HTTPRespSendBusy(req);
+    char *out = HTTPBufLease();
+    if (!out)
+    {
+        HTTPBufRelease(value);
+        return HTTPRespSendBusy(req);
+    }
+    jwOpen(&jwc, out, SCRATCH_BUFSIZE, JW_OBJECT, JW_COMPACT);
+    api_vars_ctx_t ctx = { .jwc = &jwc, .value = value };
+    ForEachAPIVar(names, since, &ctx);
+    if (jwClose(&jwc) != JWRITE_OK)
+    {
+        /* Too large for one buffer, read the variables again streaming them */
+        http_writer_t w;
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+        httpd_resp_set_hdr(req, "X-Vars-Generation", generation);
+        HTTPWriterInit(&w, req, out, MIN(HTTP_WRITER_BUFSIZE, SCRATCH_BUFSIZE));
+        ctx = (api_vars_ctx_t) { .w = &w, .value = value };
+        HTTPWrite(&w, "{", 1);
+        ForEachAPIVar(names, since, &ctx);
+        HTTPWrite(&w, "}", 1);
+        HTTPWriterEnd(&w);
+        HTTPBufRelease(value);
+        HTTPBufRelease(out);
+        return (w.err == ESP_OK) ? ESP_OK : ESP_FAIL;
+    }
+    HTTPBufRelease(value);
 
+    /* Dashboard polls the same set of variables, 304 if nothing changed */
+    size_t len = strlen(out);
+    snprintf(etag, sizeof(etag), "\"%08lx\"", (unsigned long) crc32(0, (uint8_t const*) out, len));
+    httpd_resp_set_hdr(req, "ETag", etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    httpd_resp_set_hdr(req, "X-Vars-Generation", generation);
+    if (IsETagMatched(req, etag))
+    {
+        httpd_resp_set_status(req, "304 Not Modified");
+        httpd_resp_send(req, NULL, 0);
+    }
+    else
+    {
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_send(req, out, len);
+    }
+    HTTPBufRelease(out);
     return ESP_OK;
 }
 
+#if CONFIG_WEBGUIAPP_HTTP_CACHE_ENABLE
+static bool ReadROMAsset(const char *path, char *buf, size_t size)
+{
+    espfs_file_t *file = espfs_fopen(fs, path);
+    if (!file)
+        return false;
+    bool res = (espfs_fread(file, buf, size) == size);
+    espfs_fclose(file);
+    return res;
+}
+#endif
+
 static esp_err_t GETHandler(httpd_req_t *req)
 {
 #if HTTP_SERVER_DEBUG_LEVEL > 0
     ESP_LOGI(TAG, "GET request handle URL: %s", req->uri);
 #endif
 
-    if(userappurl && HTTPUserAppGETHandler)
-    {
-        if (memmem(req->uri, strlen(req->uri), userappurl, strlen(userappurl)))
-            return HTTPUserAppGETHandler(req);
-    }
-
-    //Route to file server GET handler
-    if (memmem(req->uri, strlen(req->uri), "/storage/", sizeof("/storage/") - 1))
-        return download_get_handler(req);
-
     char filepath[FILE_PATH_MAX];
     espfs_file_t *file;
-    struct espfs_stat_t stat;
     const char *filename = get_path_from_uri(filepath,
                                              ((struct file_server_data*) req->user_ctx)->base_path,
                                              req->uri,
@@ -326,40 +631,110 @@ static esp_err_t GETHandler(httpd_req_t *req)
     {
         return ESP_FAIL;
     }
+    const romfs_asset_t *asset = GetROMAsset(filename);
+    if (!asset)
+    {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "File not found");
+        return ESP_FAIL;
+    }
+    /* Page with variables is built on each request and never cached */
+    if (asset->tpl)
+    {
+        httpd_resp_set_type(req, asset->mime);
+        httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+        return HTTPTemplateRender(req, asset->tpl);
+    }
+    int accepted = HTTPGetAcceptedEncodings(req);
+    if (asset->gz || asset->br || asset->encoding)
+    {
+        httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+        asset = SelectAssetVariant(asset, accepted);
+    }
+    /* File is stored only compressed and client can't decode it, unpacking
+     * needs 32k dictionary, too much for the request */
+    if (asset->encoding &&
+            !(accepted & ((!strcmp(asset->encoding, "br")) ? HTTP_ENCODING_BR : HTTP_ENCODING_GZIP)))
+    {
+        httpd_resp_set_status(req, "406 Not Acceptable");
+        httpd_resp_set_type(req, HTTPD_TYPE_TEXT);
+        httpd_resp_sendstr(req, "Content is available only compressed");
+        return ESP_FAIL;
+    }
+    if (asset->etag[0])
+        httpd_resp_set_hdr(req, "ETag", asset->etag);
+    if (IsHashedAssetName(filename))
+        httpd_resp_set_hdr(req, "Cache-Control",
+                           "public, max-age=" HTTP_STR(CONFIG_WEBGUIAPP_HTTP_IMMUTABLE_MAX_AGE) ", immutable");
+    else
+        httpd_resp_set_hdr(req, "Cache-Control", "max-age=" HTTP_STR(CONFIG_WEBGUIAPP_HTTP_ASSET_MAX_AGE));
+
+    /* Browser already has actual version of the file */
+    if (asset->etag[0] && IsETagMatched(req, asset->etag))
+    {
+        httpd_resp_set_status(req, "304 Not Modified");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    }
+
+    httpd_resp_set_type(req, asset->mime);
+    if (asset->encoding)
+        httpd_resp_set_hdr(req, "Content-Encoding", asset->encoding);
+
+    /* File stored uncompressed in the mapped image, send it directly
+     * from flash with exact Content-Length */
+    if (asset->data)
+    {
+#if HTTP_SERVER_DEBUG_LEVEL > 0
+        ESP_LOGI(TAG, "Send mapped file : %s (%d bytes)", filename, asset->size);
+#endif
+        if (httpd_resp_send(req, (const char*) asset->data, asset->size) != ESP_OK)
+        {
+            ESP_LOGE(TAG, "File sending failed!");
+            return ESP_FAIL;
+        }
+        return ESP_OK;
+    }
+
+#if CONFIG_WEBGUIAPP_HTTP_CACHE_ENABLE
+    /* Content compressed by espfs is unpacked once and sent from RAM */
+    const http_cache_entry_t *cached = HTTPCacheGet(asset->path, 0, asset->size, ReadROMAsset);
+    if (cached)
+    {
+        esp_err_t res = httpd_resp_send(req, cached->data, cached->size);
+        HTTPCacheRelease(cached);
+        if (res != ESP_OK)
+        {
+            ESP_LOGE(TAG, "File sending failed!");
+            return ESP_FAIL;
+        }
+        return ESP_OK;
+    }
+#endif
+
 //open file
-    file = espfs_fopen(fs, filepath);
+    file = espfs_fopen(fs, asset->path);
     if (!file)
     {
         httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "File not found");
         return ESP_FAIL;
     }
-//get file info
-    espfs_stat(fs, filepath, &stat);
 
 #if HTTP_SERVER_DEBUG_LEVEL > 0
     ESP_LOGI(TAG, "BEGIN send file : %s (%d bytes)...", filename,
-             stat.size);
+             asset->size);
 #endif
 
-    set_content_type_from_file(req, filename);
-    httpd_resp_set_hdr(req, "Cache-Control", "max-age=600");
-    httpd_resp_set_hdr(req, "Connection", "close");
-
-    /*Check if content of file is compressed*/
-    char file_header[3];
-    espfs_fread(file, file_header, 3);
-    if (!memcmp(file_header, GZIP_SIGN, 3))
+    /* Lease buffer for temporary storage */
+    char *chunk = HTTPBufLease();
+    if (!chunk)
     {
-        httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+        espfs_fclose(file);
+        return HTTPRespSendBusy(req);
     }
-    espfs_fseek(file, 0, SEEK_SET); //return to begin of file
-
-    /* Retrieve the pointer to scratch buffer for temporary storage */
-    char *chunk = ((struct file_server_data*) req->user_ctx)->scratch;
     size_t chunksize;
     do
     {
-        /* Read file in chunks into the scratch buffer */
+        /* Read file in chunks into the leased buffer */
         chunksize = espfs_fread(file, chunk, SCRATCH_BUFSIZE);
         if (chunksize > 0)
         {
@@ -367,6 +742,7 @@ static esp_err_t GETHandler(httpd_req_t *req)
             if (httpd_resp_send_chunk(req, chunk, chunksize) != ESP_OK)
             {
                 espfs_fclose(file);
+                HTTPBufRelease(chunk);
                 ESP_LOGE(TAG, "File sending failed!");
                 /* Abort sending file */
                 httpd_resp_sendstr_chunk(req, NULL);
@@ -380,9 +756,10 @@ static esp_err_t GETHandler(httpd_req_t *req)
     while (chunksize != 0);
     /* Close file after sending complete */
     espfs_fclose(file);
+    HTTPBufRelease(chunk);
 #if HTTP_SERVER_DEBUG_LEVEL > 0
     ESP_LOGI(TAG, "END send file : %s (%d bytes)...", filename,
-             stat.size);
+             asset->size);
 #endif
     /* Respond with an empty chunk to signal HTTP response completion */
 #ifdef CONFIG_EXAMPLE_HTTPD_CONN_CLOSE_HEADER
@@ -392,11 +769,245 @@ static esp_err_t GETHandler(httpd_req_t *req)
     return ESP_OK;
 }
 
+#if CONFIG_WEBGUIAPP_HTTP_METRICS_ENABLE
+/* Sessions by socket for send override, which may be called by async worker */
+static http_sess_ctx_t *metered[CONFIG_WEBGUIAPP_HTTP_MAX_OPEN_SOCKETS];
+
+/* Same as default send of httpd, counts bytes and gets status of response */
+static int HTTPMeteredSend(httpd_handle_t hd, int sockfd, const char *buf, size_t buf_len, int flags)
+{
+    if (buf == NULL)
+        return HTTPD_SOCK_ERR_INVALID;
+    int ret = send(sockfd, buf, buf_len, flags);
+    if (ret < 0)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            return HTTPD_SOCK_ERR_TIMEOUT;
+        return HTTPD_SOCK_ERR_FAIL;
+    }
+    for (int i = 0; i < CONFIG_WEBGUIAPP_HTTP_MAX_OPEN_SOCKETS; i++)
+    {
+        http_sess_ctx_t *ctx = metered[i];
+        if (ctx && ctx->fd == sockfd)
+        {
+            if (ctx->req_start)
+            {
+                /* Status line goes first with the headers */
+                if (ctx->status == 0 && ret > 12 && !memcmp(buf, "HTTP/1.", 7))
+                    ctx->status = atoi(buf + 9);
+                ctx->bytes_out += ret;
+            }
+            break;
+        }
+    }
+    return ret;
+}
+
+static void HTTPSessionFree(void *arg)
+{
+    for (int i = 0; i < CONFIG_WEBGUIAPP_HTTP_MAX_OPEN_SOCKETS; i++)
+    {
+        if (metered[i] == arg)
+            metered[i] = NULL;
+    }
+    HTTPMetricsConnection(false);
+    free(arg);
+}
+#endif
+
+static esp_err_t HTTPSessionOpen(httpd_handle_t hd, int sockfd)
+{
+    http_sess_ctx_t *ctx = calloc(1, sizeof(http_sess_ctx_t));
+    if (!ctx)
+        return ESP_ERR_NO_MEM;
+    ctx->last_activity = esp_timer_get_time();
+#if CONFIG_WEBGUIAPP_HTTP_METRICS_ENABLE
+    ctx->fd = sockfd;
+    for (int i = 0; i < CONFIG_WEBGUIAPP_HTTP_MAX_OPEN_SOCKETS; i++)
+    {
+        if (!metered[i])
+        {
+            metered[i] = ctx;
+            break;
+        }
+    }
+    HTTPMetricsConnection(true);
+    httpd_sess_set_ctx(hd, sockfd, ctx, HTTPSessionFree);
+    httpd_sess_set_send_override(hd, sockfd, HTTPMeteredSend);
+#else
+    httpd_sess_set_ctx(hd, sockfd, ctx, free);
+#endif
+    return ESP_OK;
+}
+
+#if CONFIG_WEBGUIAPP_HTTP_WS_ENABLE
+static void HTTPSessionClose(httpd_handle_t hd, int sockfd)
+{
+    HTTPWebSocketRemove(sockfd);
+    close(sockfd);
+}
+#endif
+
+/* Account request on the connection and set connection related headers */
+static void HTTPSessionBegin(httpd_req_t *req)
+{
+    http_sess_ctx_t *ctx = (http_sess_ctx_t*) req->sess_ctx;
+#if CONFIG_WEBGUIAPP_HTTP_KEEPALIVE_ENABLE
+    if (ctx)
+    {
+        ctx->busy = true;
+        ctx->last_activity = esp_timer_get_time();
+        if (++ctx->requests >= CONFIG_WEBGUIAPP_HTTP_KEEPALIVE_MAX_REQUESTS)
+            ctx->close_after = true;
+    }
+    if (!ctx || ctx->close_after)
+        httpd_resp_set_hdr(req, "Connection", "close");
+    else
+        httpd_resp_set_hdr(req, "Keep-Alive",
+                           "timeout=" HTTP_STR(CONFIG_WEBGUIAPP_HTTP_KEEPALIVE_IDLE_TIMEOUT)
+                           ", max=" HTTP_STR(CONFIG_WEBGUIAPP_HTTP_KEEPALIVE_MAX_REQUESTS));
+#else
+    if (ctx)
+        ctx->close_after = true;
+    httpd_resp_set_hdr(req, "Connection", "close");
+#endif
+}
+
+/* Close connection after response instead of draining unread body */
+static void HTTPSessionCloseAfter(httpd_req_t *req)
+{
+    http_sess_ctx_t *ctx = (http_sess_ctx_t*) req->sess_ctx;
+    if (ctx)
+        ctx->close_after = true;
+    httpd_resp_set_hdr(req, "Connection", "close");
+}
+
+static void HTTPSessionEnd(httpd_req_t *req)
+{
+    http_sess_ctx_t *ctx = (http_sess_ctx_t*) req->sess_ctx;
+    if (!ctx)
+        return;
+    ctx->busy = false;
+    ctx->last_activity = esp_timer_get_time();
+    if (ctx->close_after)
+        httpd_sess_trigger_close(req->handle, httpd_req_to_sockfd(req));
+}
+
+/* Executed in httpd task or in async worker task */
+esp_err_t HTTPRouteExecute(httpd_req_t *req, const http_route_t *route)
+{
+    esp_err_t res;
+    HTTPSessionBegin(req);
+    if (route)
+        res = route->handler(req);
+    else
+    {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "URL not found");
+        res = ESP_FAIL;
+    }
+    HTTPSessionEnd(req);
+#if CONFIG_WEBGUIAPP_HTTP_RATE_LIMIT_ENABLE
+    HTTPAdmissionRelease(route);
+#endif
+    HTTPRequestComplete(req, route, res);
+    return res;
+}
+
+/* Response is sent, record metrics of the request */
+void HTTPRequestComplete(httpd_req_t *req, const http_route_t *route, esp_err_t res)
+{
+#if CONFIG_WEBGUIAPP_HTTP_METRICS_ENABLE
+    http_sess_ctx_t *ctx = (http_sess_ctx_t*) req->sess_ctx;
+    if (!ctx || !ctx->req_start)
+        return;
+    HTTPMetricsRecord(route, ctx->status, req->content_len, ctx->bytes_out,
+                      esp_timer_get_time() - ctx->req_start, res != ESP_OK);
+    ctx->req_start = 0;
+#endif
+}
+
+static esp_err_t HTTPRequestHandler(httpd_req_t *req)
+{
+    const http_route_t *route = HTTPRouteFind(req->method, req->uri);
+#if CONFIG_WEBGUIAPP_HTTP_METRICS_ENABLE
+    http_sess_ctx_t *mctx = (http_sess_ctx_t*) req->sess_ctx;
+    if (mctx)
+    {
+        mctx->status = 0;
+        mctx->bytes_out = 0;
+        mctx->req_start = esp_timer_get_time();
+        HTTPMetricsBegin();
+    }
+#endif
+#if CONFIG_WEBGUIAPP_HTTP_RATE_LIMIT_ENABLE
+    if (HTTPAdmissionCheck(req, route) != ESP_OK)
+    {
+        HTTPRequestComplete(req, route, ESP_FAIL);
+        return ESP_FAIL;
+    }
+#endif
+    if (route && (route->flags & HTTP_ROUTE_FLAG_ASYNC))
+    {
+        /* Keep idle sweep away from the session while request waits for worker */
+        http_sess_ctx_t *ctx = (http_sess_ctx_t*) req->sess_ctx;
+        if (ctx)
+            ctx->busy = true;
+        esp_err_t res = HTTPAsyncSubmit(req, route);
+        if (ctx && res != ESP_OK)
+            ctx->busy = false;
+        return res;
+    }
+    return HTTPRouteExecute(req, route);
+}
+
+#if CONFIG_WEBGUIAPP_HTTP_KEEPALIVE_ENABLE
+/* Executed in the httpd task context, closes connections idle for too long */
+static void HTTPIdleSweep(void *arg)
+{
+    httpd_handle_t hd = (httpd_handle_t) arg;
+    int client_fds[CONFIG_WEBGUIAPP_HTTP_MAX_OPEN_SOCKETS];
+    size_t fds = CONFIG_WEBGUIAPP_HTTP_MAX_OPEN_SOCKETS;
+    if (httpd_get_client_list(hd, &fds, client_fds) != ESP_OK)
+        return;
+    int64_t now = esp_timer_get_time();
+    for (int i = 0; i < fds; i++)
+    {
+#if CONFIG_WEBGUIAPP_HTTP_WS_ENABLE
+        /* WebSocket subscriber is idle between pushes by design */
+        if (httpd_ws_get_fd_info(hd, client_fds[i]) == HTTPD_WS_CLIENT_WEBSOCKET)
+            continue;
+#endif
+        http_sess_ctx_t *ctx = (http_sess_ctx_t*) httpd_sess_get_ctx(hd, client_fds[i]);
+        if (ctx && !ctx->busy &&
+                (now - ctx->last_activity) > (int64_t) CONFIG_WEBGUIAPP_HTTP_KEEPALIVE_IDLE_TIMEOUT * 1000000)
+        {
+#if HTTP_SERVER_DEBUG_LEVEL > 0
+            ESP_LOGI(TAG, "Close idle connection %d", client_fds[i]);
+#endif
+            httpd_sess_trigger_close(hd, client_fds[i]);
+        }
+    }
+}
+
+static void HTTPIdleTimerCallback(void *arg)
+{
+    if (server)
+        httpd_queue_work(server, HTTPIdleSweep, server);
+}
+#endif
+
 static httpd_handle_t start_webserver(void)
 {
     httpd_handle_t server = NULL;
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-    config.lru_purge_enable = false;
+    config.max_open_sockets = CONFIG_WEBGUIAPP_HTTP_MAX_OPEN_SOCKETS;
+    /* When all sockets are busy recycle the least recently used one
+     * instead of refusing new clients */
+    config.lru_purge_enable = true;
+    config.open_fn = HTTPSessionOpen;
+#if CONFIG_WEBGUIAPP_HTTP_WS_ENABLE
+    config.close_fn = HTTPSessionClose;
+#endif
     config.uri_match_fn = httpd_uri_match_wildcard;
     config.stack_size = (4096 + 2048);
 
@@ -406,10 +1017,21 @@ static httpd_handle_t start_webserver(void)
     {
         // Set URI handlers
         ESP_LOGI(TAG, "Registering URI handlers");
+#if CONFIG_WEBGUIAPP_HTTP_WS_ENABLE
+        /* Must be registered before wildcard handlers to be matched first */
+        httpd_uri_t ws = { .uri = "/ws",
+                .method = HTTP_GET,
+                .handler = HTTPWebSocketHandler,
+                .user_ctx = server_data,
+                .is_websocket = true
+                };
+        httpd_register_uri_handler(server, &ws);
+#endif
+
         /* URI handler for GET request */
         httpd_uri_t get = { .uri = "/*",
                 .method = HTTP_GET,
-                .handler = GETHandler,
+                .handler = HTTPRequestHandler,
                 .user_ctx = server_data // Pass server data as context
                 };
         httpd_register_uri_handler(server, &get);
@@ -417,7 +1039,7 @@ static httpd_handle_t start_webserver(void)
         /* URI handler for POST request */
         httpd_uri_t post = { .uri = "/*",
                 .method = HTTP_POST,
-                .handler = POSTHandler,
+                .handler = HTTPRequestHandler,
                 .user_ctx = server_data // Pass server data as context
                 };
         httpd_register_uri_handler(server, &post);
@@ -427,23 +1049,103 @@ static httpd_handle_t start_webserver(void)
     return NULL;
 }
 
-static void stop_webserver(httpd_handle_t server)
+static uint32_t restarts_avoided = 0;
+
+uint32_t HTTPGetRestartsAvoided(void)
 {
-// Stop the httpd server
-    httpd_stop(server);
+    return restarts_avoided;
 }
 
+/* Local address of connection is not assigned to any interface anymore */
+static bool IsLocalAddrStale(int fd)
+{
+    struct sockaddr_storage addr;
+    socklen_t len = sizeof(addr);
+    uint32_t ip;
+    if (getsockname(fd, (struct sockaddr*) &addr, &len) != 0)
+        return false;
+    if (addr.ss_family == AF_INET)
+        ip = ((struct sockaddr_in*) &addr)->sin_addr.s_addr;
+    else if (addr.ss_family == AF_INET6)
+    {
+        /* IPv4 client on dual stack socket has address ::ffff:a.b.c.d */
+        static const uint8_t V4MAPPED[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff };
+        const uint8_t *a6 = ((struct sockaddr_in6*) &addr)->sin6_addr.s6_addr;
+        if (memcmp(a6, V4MAPPED, sizeof(V4MAPPED)))
+            return false;
+        memcpy(&ip, &a6[12], sizeof(ip));
+    }
+    else
+        return false;
+
+    esp_netif_t *netif = esp_netif_next(NULL);
+    while (netif != NULL)
+    {
+        esp_netif_ip_info_t ip_info;
+        if (esp_netif_get_ip_info(netif, &ip_info) == ESP_OK && ip_info.ip.addr == ip)
+            return false;
+        netif = esp_netif_next(netif);
+    }
+    return true;
+}
+
+/* Executed in context of httpd task */
+static void HTTPStaleSessionsSweep(void *arg)
+{
+    httpd_handle_t hd = (httpd_handle_t) arg;
+    int client_fds[CONFIG_WEBGUIAPP_HTTP_MAX_OPEN_SOCKETS];
+    size_t fds = CONFIG_WEBGUIAPP_HTTP_MAX_OPEN_SOCKETS;
+    if (httpd_get_client_list(hd, &fds, client_fds) != ESP_OK)
+        return;
+    for (int i = 0; i < fds; i++)
+    {
+        if (IsLocalAddrStale(client_fds[i]))
+        {
+            ESP_LOGI(TAG, "Close connection %d bound to lost address", client_fds[i]);
+            httpd_sess_trigger_close(hd, client_fds[i]);
+        }
+    }
+}
+
+/* Server listens on any address, so there is no need to restart it
+ * on IP change. Only connections bound to the address gone are closed */
 static void reconnect_handler(void *arg, esp_event_base_t event_base,
                               int32_t event_id,
                               void *event_data)
 {
     httpd_handle_t *server = (httpd_handle_t*) arg;
-    if (*server)
+    if (!*server)
+    {
+        if (event_id == IP_EVENT_STA_GOT_IP || event_id == IP_EVENT_ETH_GOT_IP || event_id == IP_EVENT_PPP_GOT_IP)
+        {
+            ESP_LOGI(TAG, "Any adapter got IP. Start web server.");
+            *server = start_webserver();
+        }
+        return;
+    }
+    if (event_id == IP_EVENT_STA_GOT_IP || event_id == IP_EVENT_ETH_GOT_IP || event_id == IP_EVENT_PPP_GOT_IP)
     {
-        ESP_LOGI(TAG, "Any adapter got new IP. Restart web server.");
-        stop_webserver(*server);
-        *server = start_webserver();
+        restarts_avoided++;
+        if (!((ip_event_got_ip_t*) event_data)->ip_changed)
+            return;
     }
+    httpd_queue_work(*server, HTTPStaleSessionsSweep, *server);
+}
+
+/* Handlers doing flash I/O, NVS commits, WiFi scan or modem requests
+ * are offloaded to async workers, static files are served inline.
+ * Expensive routes have own rate limit and concurrency cap */
+#define HTTP_ROUTE_FLAGS_HEAVY (HTTP_ROUTE_FLAG_ASYNC | HTTP_ROUTE_FLAG_EXPENSIVE)
+static void RegisterSystemRoutes(void)
+{
+    HTTPRouteRegister(url_api, HTTP_POST, HTTP_ROUTE_EXACT, HTTP_ROUTE_FLAGS_HEAVY, SysAPIPOSTHandler);
+    HTTPRouteRegister("/api/vars", HTTP_GET, HTTP_ROUTE_EXACT, HTTP_ROUTE_FLAGS_HEAVY, SysAPIVarsGETHandler);
+    HTTPRouteRegister("/login", HTTP_POST, HTTP_ROUTE_EXACT, HTTP_ROUTE_FLAG_EXPENSIVE, HTTPAuthLoginHandler);
+    HTTPRouteRegister("/logout", HTTP_POST, HTTP_ROUTE_EXACT, 0, HTTPAuthLogoutHandler);
+    HTTPRouteRegister("/storage/upload/", HTTP_POST, HTTP_ROUTE_PREFIX, HTTP_ROUTE_FLAGS_HEAVY, upload_post_handler);
+    HTTPRouteRegister("/storage/delete/", HTTP_POST, HTTP_ROUTE_PREFIX, HTTP_ROUTE_FLAGS_HEAVY, delete_post_handler);
+    HTTPRouteRegister("/storage/", HTTP_GET, HTTP_ROUTE_PREFIX, 0, download_get_handler);
+    HTTPRouteRegister("/", HTTP_GET, HTTP_ROUTE_PREFIX, 0, GETHandler);
 }
 
 /* Function to start the file server */
@@ -456,6 +1158,10 @@ esp_err_t start_file_server(void)
     }
     ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &reconnect_handler, &server));
     ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_ETH_GOT_IP, &reconnect_handler, &server));
+    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_PPP_GOT_IP, &reconnect_handler, &server));
+    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_LOST_IP, &reconnect_handler, &server));
+    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_ETH_LOST_IP, &reconnect_handler, &server));
+    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_PPP_LOST_IP, &reconnect_handler, &server));
 
     /* Allocate memory for server data */
     server_data = calloc(1, sizeof(struct file_server_data));
@@ -470,6 +1176,25 @@ esp_err_t start_file_server(void)
 #else
     strlcpy(server_data->base_path2, "/data", sizeof("/data"));
 #endif
+    if (HTTPBufPoolInit() != ESP_OK)
+        return ESP_ERR_NO_MEM;
+    if (HTTPAsyncInit() != ESP_OK)
+        return ESP_ERR_NO_MEM;
+#if CONFIG_WEBGUIAPP_HTTP_CACHE_ENABLE
+    HTTPCacheInit();
+#endif
+#if CONFIG_WEBGUIAPP_HTTP_WS_ENABLE
+    ESP_ERROR_CHECK(HTTPWebSocketInit());
+#endif
+    RegisterSystemRoutes();
     server = start_webserver();
+#if CONFIG_WEBGUIAPP_HTTP_KEEPALIVE_ENABLE
+    const esp_timer_create_args_t idle_timer_args = {
+            .callback = &HTTPIdleTimerCallback,
+            .name = "http_idle"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&idle_timer_args, &idle_timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(idle_timer, 1000000));
+#endif
     return ESP_OK;
 }
@@ -0,0 +1,224 @@
+/* Copyright 2026 Bogdan Pilyugin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   File name: HTTPTemplate.c
+ *     Project: webguiapp
+ *  Created on: 2026-10-17
+ *      Author: bogdan
+ * Description:	
+ */
+
+#include "HTTPServer.h"
+#include <ctype.h>
+
+#define TAG "HTTPTemplate"
+
+/* HTML page in espfs may contain ~name~ markers, each one is replaced
+ * with the current value of the variable when the page is sent. Page is
+ * split into literal and variable segments once on mount, so sending
+ * does not search for markers again. Only variables readable without
+ * side effects are substituted, other markers are sent as is */
+
+typedef struct
+{
+    const char *text; /* Literal text or variable name without tildes */
+    size_t len;
+    bool var;
+} http_tpl_seg_t;
+
+struct http_tpl_s
+{
+    char *copy; /* Content read from file compressed by espfs, else NULL */
+    int nseg;
+    http_tpl_seg_t seg[];
+};
+
+extern espfs_fs_t *fs;
+
+/* Length of variable name if p points to a marker, else 0 */
+static int GetMarkerLength(const char *p, const char *end)
+{
+    const char *s = p + 1;
+    while (s < end && (s - p) < VAR_MAX_NAME_LENGTH && (isalnum((unsigned char) *s) || *s == '_'))
+        s++;
+    if (s == p + 1 || s >= end || *s != '~')
+        return 0;
+    return s - p - 1;
+}
+
+/* Split content into segments, with seg == NULL only count them */
+static int ScanSegments(const char *content, size_t size, http_tpl_seg_t *seg, int *nvars)
+{
+    const char *end = content + size;
+    const char *lit = content;
+    const char *p = content;
+    int n = 0;
+    *nvars = 0;
+    while (p < end && (p = memchr(p, '~', end - p)) != NULL)
+    {
+        int namelen = GetMarkerLength(p, end);
+        if (!namelen)
+        {
+            p++;
+            continue;
+        }
+        if (p > lit)
+        {
+            if (seg)
+                seg[n] = (http_tpl_seg_t ) { lit, p - lit, false };
+            n++;
+        }
+        if (seg)
+            seg[n] = (http_tpl_seg_t ) { p + 1, namelen, true };
+        n++;
+        (*nvars)++;
+        p += namelen + 2;
+        lit = p;
+    }
+    if (end > lit)
+    {
+        if (seg)
+            seg[n] = (http_tpl_seg_t ) { lit, end - lit, false };
+        n++;
+    }
+    return n;
+}
+
+static char* ReadAsset(const romfs_asset_t *asset)
+{
+    espfs_file_t *file = espfs_fopen(fs, asset->path);
+    if (!file)
+        return NULL;
+    char *copy = malloc(asset->size);
+    if (copy && espfs_fread(file, copy, asset->size) != asset->size)
+    {
+        free(copy);
+        copy = NULL;
+    }
+    espfs_fclose(file);
+    return copy;
+}
+
+/* Returns parsed template or NULL if the page has no markers */
+http_tpl_t* HTTPTemplateParse(const romfs_asset_t *asset)
+{
+    const char *content = (const char*) asset->data;
+    char *copy = NULL;
+    int nvars;
+    if (!content)
+    {
+        content = copy = ReadAsset(asset);
+        if (!content)
+            return NULL;
+    }
+    int nseg = ScanSegments(content, asset->size, NULL, &nvars);
+    if (nvars == 0)
+    {
+        free(copy);
+        return NULL;
+    }
+    http_tpl_t *tpl = malloc(sizeof(http_tpl_t) + nseg * sizeof(http_tpl_seg_t));
+    if (!tpl)
+    {
+        ESP_LOGE(TAG, "Failed to allocate template %s", asset->path);
+        free(copy);
+        return NULL;
+    }
+    tpl->copy = copy;
+    tpl->nseg = ScanSegments(content, asset->size, tpl->seg, &nvars);
+#if HTTP_SERVER_DEBUG_LEVEL > 0
+    ESP_LOGI(TAG, "Template %s: %d segments, %d variables", asset->path, nseg, nvars);
+#endif
+    return tpl;
+}
+
+/* Values are inserted into HTML, so markup characters are escaped */
+static void WriteEscaped(http_writer_t *w, const char *val)
+{
+    const char *run = val;
+    for (; *val; val++)
+    {
+        const char *ent;
+        switch (*val)
+        {
+            case '&':
+                ent = "&amp;";
+            break;
+            case '<':
+                ent = "&lt;";
+            break;
+            case '>':
+                ent = "&gt;";
+            break;
+            case '"':
+                ent = "&quot;";
+            break;
+            case '\'':
+                ent = "&#39;";
+            break;
+            default:
+                continue;
+        }
+        HTTPWrite(w, run, val - run);
+        HTTPWriteStr(w, ent);
+        run = val + 1;
+    }
+    HTTPWrite(w, run, val - run);
+}
+
+/* Send page with current values of variables as chunked response */
+esp_err_t HTTPTemplateRender(httpd_req_t *req, const http_tpl_t *tpl)
+{
+    char name[VAR_MAX_NAME_LENGTH];
+    http_writer_t w;
+    rest_var_types tp;
+
+    char *value = HTTPBufLease();
+    if (!value)
+        return HTTPRespSendBusy(req);
+    /* Getters run on httpd task stack, so writer buffer is leased too */
+    char *wbuf = HTTPBufLease();
+    if (!wbuf)
+    {
+        HTTPBufRelease(value);
+        return HTTPRespSendBusy(req);
+    }
+    HTTPWriterInit(&w, req, wbuf, MIN(HTTP_WRITER_BUFSIZE, SCRATCH_BUFSIZE));
+    for (int i = 0; i < tpl->nseg && w.err == ESP_OK; i++)
+    {
+        const http_tpl_seg_t *seg = &tpl->seg[i];
+        if (!seg->var)
+        {
+            HTTPWrite(&w, seg->text, seg->len);
+            continue;
+        }
+        memcpy(name, seg->text, seg->len);
+        name[seg->len] = 0x00;
+        value[0] = 0x00; //don't pass previous content as an argument
+        if (IsConfVarReadSafe(name) && GetConfVar(name, value, &tp) == ESP_OK)
+            WriteEscaped(&w, value);
+        else
+            /* Not a variable or can't be read by page GET, keep the text as is */
+            HTTPWrite(&w, seg->text - 1, seg->len + 2);
+    }
+    HTTPWriterEnd(&w);
+    HTTPBufRelease(wbuf);
+    HTTPBufRelease(value);
+    if (w.err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Template sending failed!");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
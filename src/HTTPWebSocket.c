@@ -0,0 +1,235 @@
+/* Copyright 2026 Bogdan Pilyugin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *   File name: HTTPWebSocket.c
+ *     Project: webguiapp
+ *  Created on: 2026-10-17
+ *      Author: bogdan
+ * Description:	
+ */
+
+#include "HTTPServer.h"
+#include "esp_timer.h"
+#include "jWrite.h"
+#include "jRead.h"
+
+#define TAG "HTTPWebSocket"
+
+/* Client sends {"subscribe":["uptime","free_ram"],"interval":2000}
+ * and gets JSON object with values of subscribed variables changed
+ * since the previous push. First push after subscription has all values */
+
+#define WS_REQUEST_MAX_LENGTH   1024
+
+typedef struct
+{
+    int fd;
+    int nvars;
+    int interval_ms;
+    int64_t next_push;
+    char names[CONFIG_WEBGUIAPP_HTTP_WS_MAX_VARS][VAR_MAX_NAME_LENGTH];
+    uint32_t hash[CONFIG_WEBGUIAPP_HTTP_WS_MAX_VARS];
+    bool sent[CONFIG_WEBGUIAPP_HTTP_WS_MAX_VARS];
+} ws_client_t;
+
+extern httpd_handle_t server;
+
+/* Accessed only from httpd task: handler, close callback and push work */
+static ws_client_t clients[CONFIG_WEBGUIAPP_HTTP_WS_MAX_CLIENTS];
+static esp_timer_handle_t push_timer = NULL;
+
+static ws_client_t* GetClient(int fd, bool create)
+{
+    ws_client_t *free_slot = NULL;
+    for (int i = 0; i < CONFIG_WEBGUIAPP_HTTP_WS_MAX_CLIENTS; i++)
+    {
+        if (clients[i].nvars > 0 && clients[i].fd == fd)
+            return &clients[i];
+        if (!free_slot && clients[i].nvars == 0)
+            free_slot = &clients[i];
+    }
+    return (create) ? free_slot : NULL;
+}
+
+void HTTPWebSocketRemove(int fd)
+{
+    ws_client_t *cl = GetClient(fd, false);
+    if (cl)
+        memset(cl, 0, sizeof(ws_client_t));
+}
+
+/* Values are marked as sent only after the frame with them is sent.
+ * Variables not fitting in the frame are left for the next push */
+static void PushClient(httpd_handle_t hd, ws_client_t *cl, char *value, char *out)
+{
+    struct jWriteControl jwc;
+    rest_var_types tp;
+    uint32_t hash[CONFIG_WEBGUIAPP_HTTP_WS_MAX_VARS];
+    bool pushed[CONFIG_WEBGUIAPP_HTTP_WS_MAX_VARS];
+    int changed = 0;
+    jwOpen(&jwc, out, SCRATCH_BUFSIZE, JW_OBJECT, JW_COMPACT);
+    for (int i = 0; i < cl->nvars; i++)
+    {
+        pushed[i] = false;
+        tp = VAR_ERROR;
+        if (GetConfVar(cl->names[i], value, &tp) != ESP_OK)
+            continue;
+        hash[i] = crc32(0, (uint8_t const*) value, strlen(value));
+        if (cl->sent[i] && cl->hash[i] == hash[i])
+            continue;
+        bool str = (tp == VAR_STRING || tp == VAR_IPADDR || tp == VAR_ERROR);
+        /* String can grow twice by escaping, plus quotes, colon, comma and closing brace */
+        size_t need = strlen(cl->names[i]) + strlen(value) * ((str) ? 2 : 1) + 8;
+        if ((size_t) (jwc.bufp - jwc.buffer) + need > SCRATCH_BUFSIZE)
+        {
+            if (changed == 0)
+            {
+                ESP_LOGW(TAG, "Value of %s is too large to push", cl->names[i]);
+                cl->hash[i] = hash[i];
+                cl->sent[i] = true;
+            }
+            continue;
+        }
+        if (str)
+            jwObj_string(&jwc, cl->names[i], value);
+        else
+            jwObj_raw(&jwc, cl->names[i], value);
+        pushed[i] = true;
+        changed++;
+    }
+    if (jwClose(&jwc) != JWRITE_OK || changed == 0)
+        return;
+    httpd_ws_frame_t frame = {
+            .type = HTTPD_WS_TYPE_TEXT,
+            .payload = (uint8_t*) out,
+            .len = strlen(out)
+    };
+    if (httpd_ws_send_frame_async(hd, cl->fd, &frame) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Push to %d failed, unsubscribe", cl->fd);
+        memset(cl, 0, sizeof(ws_client_t));
+        return;
+    }
+    for (int i = 0; i < cl->nvars; i++)
+    {
+        if (pushed[i])
+        {
+            cl->hash[i] = hash[i];
+            cl->sent[i] = true;
+        }
+    }
+}
+
+/* Executed in context of httpd task */
+static void PushWork(void *arg)
+{
+    httpd_handle_t hd = (httpd_handle_t) arg;
+    int64_t now = esp_timer_get_time();
+    char *value = NULL;
+    char *out = NULL;
+    for (int i = 0; i < CONFIG_WEBGUIAPP_HTTP_WS_MAX_CLIENTS; i++)
+    {
+        ws_client_t *cl = &clients[i];
+        if (cl->nvars == 0 || now < cl->next_push)
+            continue;
+        if (!value && !(value = malloc(VAR_MAX_VALUE_LENGTH)))
+            break;
+        if (!out && !(out = HTTPBufLease()))
+            break;
+        cl->next_push = now + (int64_t) cl->interval_ms * 1000;
+        PushClient(hd, cl, value, out);
+    }
+    free(value);
+    if (out)
+        HTTPBufRelease(out);
+}
+
+static void PushTimerCallback(void *arg)
+{
+    for (int i = 0; i < CONFIG_WEBGUIAPP_HTTP_WS_MAX_CLIENTS; i++)
+    {
+        if (clients[i].nvars > 0)
+        {
+            if (server)
+                httpd_queue_work(server, PushWork, server);
+            return;
+        }
+    }
+}
+
+static void Subscribe(httpd_req_t *req, char *msg)
+{
+    struct jReadElement result;
+    char name[VAR_MAX_NAME_LENGTH];
+    int fd = httpd_req_to_sockfd(req);
+
+    jRead(msg, "{'subscribe'", &result);
+    if (result.dataType != JREAD_ARRAY)
+        return;
+    HTTPWebSocketRemove(fd);
+    ws_client_t *cl = GetClient(fd, true);
+    if (!cl)
+    {
+        ESP_LOGW(TAG, "No room for subscriber");
+        return;
+    }
+    for (int i = 0; i < result.elements && cl->nvars < CONFIG_WEBGUIAPP_HTTP_WS_MAX_VARS; i++)
+    {
+        jRead_string(msg, "{'subscribe'[*", name, sizeof(name), &i);
+        if (IsConfVarReadSafe(name))
+            strcpy(cl->names[cl->nvars++], name);
+    }
+    cl->fd = fd;
+    cl->interval_ms = CONFIG_WEBGUIAPP_HTTP_WS_PUSH_INTERVAL;
+    jRead(msg, "{'interval'", &result);
+    if (result.dataType == JREAD_NUMBER)
+        cl->interval_ms = MAX(jRead_int(msg, "{'interval'", NULL), CONFIG_WEBGUIAPP_HTTP_WS_PUSH_INTERVAL);
+    /* Send all values at once on the next timer tick */
+    cl->next_push = 0;
+}
+
+esp_err_t HTTPWebSocketHandler(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET)
+    {
+        /* Handshake is done, close connection if not authorized */
+        return (HTTPIsAuthorized(req)) ? ESP_OK : ESP_FAIL;
+    }
+    httpd_ws_frame_t frame = { 0 };
+    char msg[WS_REQUEST_MAX_LENGTH];
+    if (httpd_ws_recv_frame(req, &frame, 0) != ESP_OK)
+        return ESP_FAIL;
+    if (frame.type != HTTPD_WS_TYPE_TEXT || frame.len >= sizeof(msg))
+        return ESP_OK;
+    frame.payload = (uint8_t*) msg;
+    if (httpd_ws_recv_frame(req, &frame, frame.len) != ESP_OK)
+        return ESP_FAIL;
+    msg[frame.len] = 0x00;
+    Subscribe(req, msg);
+    return ESP_OK;
+}
+
+esp_err_t HTTPWebSocketInit(void)
+{
+    if (push_timer)
+        return ESP_OK;
+    const esp_timer_create_args_t push_timer_args = {
+            .callback = &PushTimerCallback,
+            .name = "http_ws_push"
+    };
+    esp_err_t res = esp_timer_create(&push_timer_args, &push_timer);
+    if (res != ESP_OK)
+        return res;
+    return esp_timer_start_periodic(push_timer, (uint64_t) CONFIG_WEBGUIAPP_HTTP_WS_PUSH_INTERVAL * 1000);
+}
@@ -31,6 +31,11 @@
 #include "esp_idf_version.h"
 #include "NetTransport.h"
 #include "esp_vfs.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "SysVarsHash.h"
+
+#define TAG "RestApi"
 
 extern SYS_CONFIG SysConfig;
 
@@ -40,6 +45,7 @@ void SetAppVars(rest_var_t *appvars, int size)
 {
     AppVars = appvars;
     AppVarsSize = size;
+    BuildConfVarsIndex();
 }
 
 static void PrintInterfaceState(char *argres, int rw, esp_netif_t *netif)
@@ -333,6 +339,171 @@ static void funct_objsinfo(char *argres, int rw)
     GetObjectsInfo(argres);
 }
 
+static void funct_http_buf_stat(char *argres, int rw)
+{
+    http_buf_pool_stat_t st;
+    HTTPBufPoolGetStat(&st);
+    snprintf(argres, VAR_MAX_VALUE_LENGTH,
+             "{\"size\":%d,\"in_use\":%d,\"peak\":%d,\"leases\":%u,\"waits\":%u,\"exhausted\":%u}",
+             st.size, st.in_use, st.peak, (unsigned int) st.leases, (unsigned int) st.waits,
+             (unsigned int) st.exhausted);
+}
+
+static void funct_http_upload_stat(char *argres, int rw)
+{
+    http_upload_stat_t st;
+    HTTPGetUploadStat(&st);
+    snprintf(argres, VAR_MAX_VALUE_LENGTH,
+             "{\"uploads\":%u,\"bytes\":%u,\"time_ms\":%u,\"kB_per_s\":%u,\"blocked_ms\":%u,\"write_ms\":%u}",
+             (unsigned int) st.uploads, (unsigned int) st.bytes, (unsigned int) st.time_ms,
+             (unsigned int) st.kB_per_s, (unsigned int) st.blocked_ms, (unsigned int) st.write_ms);
+}
+
+#if CONFIG_WEBGUIAPP_HTTP_CACHE_ENABLE
+static void funct_http_cache_stat(char *argres, int rw)
+{
+    http_cache_stat_t st;
+    HTTPCacheGetStat(&st);
+    snprintf(argres, VAR_MAX_VALUE_LENGTH,
+             "{\"budget\":%u,\"bytes\":%u,\"entries\":%d,\"hits\":%u,\"misses\":%u,\"evictions\":%u}",
+             (unsigned int) st.budget, (unsigned int) st.bytes, st.entries, (unsigned int) st.hits,
+             (unsigned int) st.misses, (unsigned int) st.evictions);
+}
+#endif
+
+#if CONFIG_WEBGUIAPP_HTTP_METRICS_ENABLE
+static void funct_http_stats(char *argres, int rw)
+{
+    HTTPMetricsPrint(argres, VAR_MAX_VALUE_LENGTH);
+}
+#endif
+
+#if CONFIG_WEBGUIAPP_HTTP_RATE_LIMIT_ENABLE
+static void funct_http_limits_stat(char *argres, int rw)
+{
+    http_limits_stat_t st;
+    HTTPGetLimitsStat(&st);
+    snprintf(argres, VAR_MAX_VALUE_LENGTH, "{\"limited\":%u,\"busy\":%u,\"expensive_active\":%d}",
+             (unsigned int) st.limited, (unsigned int) st.busy, st.expensive_active);
+}
+#endif
+
+static void funct_http_restarts_avoided(char *argres, int rw)
+{
+    snprintf(argres, VAR_MAX_VALUE_LENGTH, "%u", (unsigned int) HTTPGetRestartsAvoided());
+}
+
+/* Values of function variables declared with cachems other than
+ * VAR_CACHE_LIVE, so reading them doesn't go to flash or drivers every time.
+ * Values longer than FUNCT_CACHE_VALUE_LENGTH are not cached */
+#define FUNCT_CACHE_SIZE 16
+#define FUNCT_CACHE_VALUE_LENGTH 64
+
+typedef struct
+{
+    const rest_var_t *var;
+    int64_t expires;
+    uint32_t hits;
+    char value[FUNCT_CACHE_VALUE_LENGTH];
+} funct_cache_t;
+
+static portMUX_TYPE funct_cache_lock = portMUX_INITIALIZER_UNLOCKED;
+static funct_cache_t FunctCache[FUNCT_CACHE_SIZE];
+static uint32_t FunctCacheHits = 0;
+static uint32_t FunctCacheMisses = 0;
+
+static bool ReadFunctCache(const rest_var_t *V, char *val)
+{
+    bool res = false;
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&funct_cache_lock);
+    for (int i = 0; i < FUNCT_CACHE_SIZE; i++)
+    {
+        funct_cache_t *C = &FunctCache[i];
+        if (C->var == V && (V->cachems == VAR_CACHE_BOOT || now < C->expires))
+        {
+            strcpy(val, C->value);
+            C->hits++;
+            res = true;
+            break;
+        }
+    }
+    if (res)
+        FunctCacheHits++;
+    else
+        FunctCacheMisses++;
+    portEXIT_CRITICAL(&funct_cache_lock);
+    return res;
+}
+
+static void StoreFunctCache(const rest_var_t *V, const char *val)
+{
+    if (strlen(val) >= FUNCT_CACHE_VALUE_LENGTH)
+        return;
+    int64_t expires = esp_timer_get_time() + (int64_t) V->cachems * 1000;
+    portENTER_CRITICAL(&funct_cache_lock);
+    funct_cache_t *C = NULL;
+    for (int i = 0; i < FUNCT_CACHE_SIZE; i++)
+    {
+        if (FunctCache[i].var == V)
+        {
+            C = &FunctCache[i];
+            break;
+        }
+        if (!C && !FunctCache[i].var)
+            C = &FunctCache[i];
+    }
+    if (C)
+    {
+        if (C->var != V)
+            C->hits = 0;
+        C->var = V;
+        C->expires = expires;
+        strcpy(C->value, val);
+    }
+    portEXIT_CRITICAL(&funct_cache_lock);
+}
+
+/* Write to a function variable can change what it reads. The entry is
+ * dropped, not expired, because VAR_CACHE_BOOT values ignore expires */
+static void InvalidateFunctCache(const rest_var_t *V)
+{
+    portENTER_CRITICAL(&funct_cache_lock);
+    for (int i = 0; i < FUNCT_CACHE_SIZE; i++)
+        if (FunctCache[i].var == V)
+        {
+            FunctCache[i].var = NULL;
+            FunctCache[i].expires = 0;
+            FunctCache[i].hits = 0;
+        }
+    portEXIT_CRITICAL(&funct_cache_lock);
+}
+
+static void funct_vars_cache_stat(char *argres, int rw)
+{
+    struct jWriteControl jwc;
+    jwOpen(&jwc, argres, VAR_MAX_VALUE_LENGTH, JW_OBJECT, JW_COMPACT);
+    portENTER_CRITICAL(&funct_cache_lock);
+    uint32_t hits = FunctCacheHits;
+    uint32_t misses = FunctCacheMisses;
+    const rest_var_t *vars[FUNCT_CACHE_SIZE];
+    uint32_t var_hits[FUNCT_CACHE_SIZE];
+    for (int i = 0; i < FUNCT_CACHE_SIZE; i++)
+    {
+        vars[i] = FunctCache[i].var;
+        var_hits[i] = FunctCache[i].hits;
+    }
+    portEXIT_CRITICAL(&funct_cache_lock);
+    jwObj_int(&jwc, "hits", (int) hits);
+    jwObj_int(&jwc, "misses", (int) misses);
+    jwObj_object(&jwc, "vars");
+    for (int i = 0; i < FUNCT_CACHE_SIZE; i++)
+        if (vars[i])
+            jwObj_int(&jwc, (char*) vars[i]->alias, (int) var_hits[i]);
+    jwEnd(&jwc);
+    jwClose(&jwc);
+}
+
 const char *EXEC_ERROR[] = {
         "EXECUTED_OK",
         "ERROR_TOO_LONG_COMMAND",
@@ -401,253 +572,474 @@ const int hw_rev = CONFIG_BOARD_HARDWARE_REVISION;
 const bool VAR_TRUE = true;
 const bool VAR_FALSE = false;
 
-const rest_var_t SystemVariables[] =
+#if REAST_API_DEBUG_MODE > 0
+static void funct_vars_lookup_bench(char *argres, int rw);
+#endif
+
+const rest_var_t SystemVariables[SYSVARS_HASH_SLOTS] =
         {
 
-        { 0, "exec", &funct_exec, VAR_FUNCT, RW, 0, 0 },
-                { 0, "time", &funct_time, VAR_FUNCT, R, 0, 0 },
-                { 0, "time_set", &funct_time_set, VAR_FUNCT, RW, 0, 0 },
-                { 0, "uptime", &funct_uptime, VAR_FUNCT, R, 0, 0 },
-                { 0, "free_ram", &funct_fram, VAR_FUNCT, R, 0, 0 },
-                { 0, "free_ram_min", &funct_fram_min, VAR_FUNCT, R, 0, 0 },
-                { 0, "def_interface", &funct_def_interface, VAR_FUNCT, R, 0, 0 },
-                { 0, "fw_rev", &funct_fw_ver, VAR_FUNCT, R, 0, 0 },
-                { 0, "idf_rev", &funct_idf_ver, VAR_FUNCT, R, 0, 0 },
-                { 0, "build_date", &funct_build_date, VAR_FUNCT, R, 0, 0 },
-
-                { 0, "model_name", CONFIG_DEVICE_MODEL_NAME, VAR_STRING, R, 1, 64 },
-                { 0, "hw_rev", ((int*) &hw_rev), VAR_INT, R, 1, 1024 },
+        [SYSVAR_SLOT(exec)] = { 0, "exec", &funct_exec, VAR_FUNCT, RW, 0, 0 },
+                [SYSVAR_SLOT(time)] = { 0, "time", &funct_time, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(time_set)] = { 0, "time_set", &funct_time_set, VAR_FUNCT, RW, 0, 0 },
+                [SYSVAR_SLOT(uptime)] = { 0, "uptime", &funct_uptime, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(free_ram)] = { 0, "free_ram", &funct_fram, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(free_ram_min)] = { 0, "free_ram_min", &funct_fram_min, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(def_interface)] = { 0, "def_interface", &funct_def_interface, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(fw_rev)] = { 0, "fw_rev", &funct_fw_ver, VAR_FUNCT, RP, 0, 0, VAR_CACHE_BOOT },
+                [SYSVAR_SLOT(idf_rev)] = { 0, "idf_rev", &funct_idf_ver, VAR_FUNCT, RP, 0, 0, VAR_CACHE_BOOT },
+                [SYSVAR_SLOT(build_date)] = { 0, "build_date", &funct_build_date, VAR_FUNCT, RP, 0, 0, VAR_CACHE_BOOT },
+
+                [SYSVAR_SLOT(model_name)] = { 0, "model_name", CONFIG_DEVICE_MODEL_NAME, VAR_STRING, R, 1, 64 },
+                [SYSVAR_SLOT(hw_rev)] = { 0, "hw_rev", ((int*) &hw_rev), VAR_INT, R, 1, 1024 },
                 //{ 0, "hw_opt", CONFIG_BOARD_HARDWARE_OPTION, VAR_STRING, R, 1, 256 },
 
-                { 0, "net_bios_name", &SysConfig.NetBIOSName, VAR_STRING, RW, 3, 31 },
-                { 0, "sys_name", &SysConfig.SysName, VAR_STRING, RW, 3, 31 },
-                { 0, "sys_pass", &SysConfig.SysPass, VAR_PASS, RW, 3, 31 },
-                { 0, "primary_color", CONFIG_WEBGUIAPP_ACCENT_COLOR, VAR_STRING, RW, 3, 31 },
-                { 0, "dark_theme", (bool*) (&VAR_TRUE), VAR_BOOL, R, 0, 1 },
-
-                { 0, "ota_url", &SysConfig.OTAURL, VAR_STRING, RW, 3, 128 },
-                { 0, "ota_auto_int", &SysConfig.OTAAutoInt, VAR_INT, RW, 0, 65535 },
-                { 0, "ota_state", &funct_ota_state, VAR_FUNCT, R, 0, 0 },
-                { 0, "ota_start", &funct_ota_start, VAR_FUNCT, R, 0, 0 },
-                { 0, "ota_newver", &funct_ota_newver, VAR_FUNCT, R, 0, 0 },
-
-                { 0, "ser_num", &SysConfig.SN, VAR_STRING, RW, 10, 10 },
-                { 0, "dev_id", &SysConfig.ID, VAR_STRING, RW, 8, 8 },
-                { 0, "color_scheme", &SysConfig.ColorSheme, VAR_INT, RW, 1, 2 },
-
-                { 0, "ota_enab", &SysConfig.Flags1.bIsOTAEnabled, VAR_BOOL, RW, 0, 1 },
-                { 0, "res_ota_enab", &SysConfig.Flags1.bIsResetOTAEnabled, VAR_BOOL, RW, 0, 1 },
-                { 0, "led_enab", &SysConfig.Flags1.bIsLedsEnabled, VAR_BOOL, RW, 0, 1 },
-                { 0, "lora_confirm", &SysConfig.Flags1.bIsLoRaConfirm, VAR_BOOL, RW, 0, 1 },
-                { 0, "tcp_confirm", &SysConfig.Flags1.bIsTCPConfirm, VAR_BOOL, RW, 0, 1 },
-
-                { 0, "sntp_timezone", &SysConfig.sntpClient.TimeZone, VAR_INT, RW, 0, 23 },
-                { 0, "sntp_serv1", &SysConfig.sntpClient.SntpServerAdr, VAR_STRING, RW, 3, 32 },
-                { 0, "sntp_serv2", &SysConfig.sntpClient.SntpServer2Adr, VAR_STRING, RW, 3, 32 },
-                { 0, "sntp_serv3", &SysConfig.sntpClient.SntpServer3Adr, VAR_STRING, RW, 3, 32 },
-                { 0, "sntp_enab", &SysConfig.sntpClient.Flags1.bIsGlobalEnabled, VAR_BOOL, RW, 0, 1 },
-
-                { 0, "lat", &funct_lat, VAR_FUNCT, RW, 0, 0 },
-                { 0, "lon", &funct_lon, VAR_FUNCT, RW, 0, 0 },
+                [SYSVAR_SLOT(net_bios_name)] = { 0, "net_bios_name", &SysConfig.NetBIOSName, VAR_STRING, RW, 3, 31 },
+                [SYSVAR_SLOT(sys_name)] = { 0, "sys_name", &SysConfig.SysName, VAR_STRING, RW, 3, 31 },
+                [SYSVAR_SLOT(sys_pass)] = { 0, "sys_pass", &SysConfig.SysPass, VAR_PASS, RW, 3, 31 },
+                [SYSVAR_SLOT(primary_color)] = { 0, "primary_color", CONFIG_WEBGUIAPP_ACCENT_COLOR, VAR_STRING, RW, 3, 31 },
+                [SYSVAR_SLOT(dark_theme)] = { 0, "dark_theme", (bool*) (&VAR_TRUE), VAR_BOOL, R, 0, 1 },
+
+                [SYSVAR_SLOT(ota_url)] = { 0, "ota_url", &SysConfig.OTAURL, VAR_STRING, RW, 3, 128 },
+                [SYSVAR_SLOT(ota_auto_int)] = { 0, "ota_auto_int", &SysConfig.OTAAutoInt, VAR_INT, RW, 0, 65535 },
+                [SYSVAR_SLOT(ota_state)] = { 0, "ota_state", &funct_ota_state, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(ota_start)] = { 0, "ota_start", &funct_ota_start, VAR_FUNCT, R, 0, 0 },
+                [SYSVAR_SLOT(ota_newver)] = { 0, "ota_newver", &funct_ota_newver, VAR_FUNCT, RP, 0, 0 },
+
+                [SYSVAR_SLOT(ser_num)] = { 0, "ser_num", &SysConfig.SN, VAR_STRING, RW, 10, 10 },
+                [SYSVAR_SLOT(dev_id)] = { 0, "dev_id", &SysConfig.ID, VAR_STRING, RW, 8, 8 },
+                [SYSVAR_SLOT(color_scheme)] = { 0, "color_scheme", &SysConfig.ColorSheme, VAR_INT, RW, 1, 2 },
+
+                [SYSVAR_SLOT(ota_enab)] = { 0, "ota_enab", &SysConfig.Flags1.bIsOTAEnabled, VAR_BOOL, RW, 0, 1 },
+                [SYSVAR_SLOT(res_ota_enab)] = { 0, "res_ota_enab", &SysConfig.Flags1.bIsResetOTAEnabled, VAR_BOOL, RW, 0, 1 },
+                [SYSVAR_SLOT(led_enab)] = { 0, "led_enab", &SysConfig.Flags1.bIsLedsEnabled, VAR_BOOL, RW, 0, 1 },
+                [SYSVAR_SLOT(lora_confirm)] = { 0, "lora_confirm", &SysConfig.Flags1.bIsLoRaConfirm, VAR_BOOL, RW, 0, 1 },
+                [SYSVAR_SLOT(tcp_confirm)] = { 0, "tcp_confirm", &SysConfig.Flags1.bIsTCPConfirm, VAR_BOOL, RW, 0, 1 },
+
+                [SYSVAR_SLOT(sntp_timezone)] = { 0, "sntp_timezone", &SysConfig.sntpClient.TimeZone, VAR_INT, RW, 0, 23 },
+                [SYSVAR_SLOT(sntp_serv1)] = { 0, "sntp_serv1", &SysConfig.sntpClient.SntpServerAdr, VAR_STRING, RW, 3, 32 },
+                [SYSVAR_SLOT(sntp_serv2)] = { 0, "sntp_serv2", &SysConfig.sntpClient.SntpServer2Adr, VAR_STRING, RW, 3, 32 },
+                [SYSVAR_SLOT(sntp_serv3)] = { 0, "sntp_serv3", &SysConfig.sntpClient.SntpServer3Adr, VAR_STRING, RW, 3, 32 },
+                [SYSVAR_SLOT(sntp_enab)] = { 0, "sntp_enab", &SysConfig.sntpClient.Flags1.bIsGlobalEnabled, VAR_BOOL, RW, 0, 1 },
+
+                [SYSVAR_SLOT(lat)] = { 0, "lat", &funct_lat, VAR_FUNCT, RWP, 0, 0 },
+                [SYSVAR_SLOT(lon)] = { 0, "lon", &funct_lon, VAR_FUNCT, RWP, 0, 0 },
 
 #if CONFIG_WEBGUIAPP_MQTT_ENABLE
-                { 0, "mqtt_1_enab", &SysConfig.mqttStation[0].Flags1.bIsGlobalEnabled, VAR_BOOL, RW, 0, 1 },
-                { 0, "mqtt_1_serv", &SysConfig.mqttStation[0].ServerAddr, VAR_STRING, RW, 3, 63 },
-                { 0, "mqtt_1_port", &SysConfig.mqttStation[0].ServerPort, VAR_INT, RW, 1, 65534 },
-                { 0, "mqtt_1_syst", &SysConfig.mqttStation[0].SystemName, VAR_STRING, RW, 3, 31 },
-                { 0, "mqtt_1_group", &SysConfig.mqttStation[0].GroupName, VAR_STRING, RW, 3, 31 },
-                { 0, "mqtt_1_clid", &SysConfig.mqttStation[0].ClientID, VAR_STRING, RW, 3, 31 },
-                { 0, "mqtt_1_uname", &SysConfig.mqttStation[0].UserName, VAR_STRING, RW, 3, 31 },
-                { 0, "mqtt_1_pass", &SysConfig.mqttStation[0].UserPass, VAR_PASS, RW, 3, 31 },
-                { 0, "mqtt_1_stat", &funct_mqtt_1_stat, VAR_FUNCT, R, 0, 0 },
-                { 0, "mqtt_1_test", &funct_mqtt_1_test, VAR_FUNCT, RW, 0, 0 },
+                [SYSVAR_SLOT(mqtt_1_enab)] = { 0, "mqtt_1_enab", &SysConfig.mqttStation[0].Flags1.bIsGlobalEnabled, VAR_BOOL, RW, 0, 1 },
+                [SYSVAR_SLOT(mqtt_1_serv)] = { 0, "mqtt_1_serv", &SysConfig.mqttStation[0].ServerAddr, VAR_STRING, RW, 3, 63 },
+                [SYSVAR_SLOT(mqtt_1_port)] = { 0, "mqtt_1_port", &SysConfig.mqttStation[0].ServerPort, VAR_INT, RW, 1, 65534 },
+                [SYSVAR_SLOT(mqtt_1_syst)] = { 0, "mqtt_1_syst", &SysConfig.mqttStation[0].SystemName, VAR_STRING, RW, 3, 31 },
+                [SYSVAR_SLOT(mqtt_1_group)] = { 0, "mqtt_1_group", &SysConfig.mqttStation[0].GroupName, VAR_STRING, RW, 3, 31 },
+                [SYSVAR_SLOT(mqtt_1_clid)] = { 0, "mqtt_1_clid", &SysConfig.mqttStation[0].ClientID, VAR_STRING, RW, 3, 31 },
+                [SYSVAR_SLOT(mqtt_1_uname)] = { 0, "mqtt_1_uname", &SysConfig.mqttStation[0].UserName, VAR_STRING, RW, 3, 31 },
+                [SYSVAR_SLOT(mqtt_1_pass)] = { 0, "mqtt_1_pass", &SysConfig.mqttStation[0].UserPass, VAR_PASS, RW, 3, 31 },
+                [SYSVAR_SLOT(mqtt_1_stat)] = { 0, "mqtt_1_stat", &funct_mqtt_1_stat, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(mqtt_1_test)] = { 0, "mqtt_1_test", &funct_mqtt_1_test, VAR_FUNCT, RW, 0, 0 },
 
 #if CONFIG_WEBGUIAPP_MQTT_CLIENTS_NUM == 2
-                { 0, "mqtt_2_enab", &SysConfig.mqttStation[1].Flags1.bIsGlobalEnabled, VAR_BOOL, RW, 0, 1 },
-                { 0, "mqtt_2_serv", &SysConfig.mqttStation[1].ServerAddr, VAR_STRING, RW, 3, 63 },
-                { 0, "mqtt_2_port", &SysConfig.mqttStation[1].ServerPort, VAR_INT, RW, 1, 65534 },
-                { 0, "mqtt_2_syst", &SysConfig.mqttStation[1].SystemName, VAR_STRING, RW, 3, 31 },
-                { 0, "mqtt_2_group", &SysConfig.mqttStation[1].GroupName, VAR_STRING, RW, 3, 31 },
-                { 0, "mqtt_2_clid", &SysConfig.mqttStation[1].ClientID, VAR_STRING, RW, 3, 31 },
-                { 0, "mqtt_2_uname", &SysConfig.mqttStation[1].UserName, VAR_STRING, RW, 3, 31 },
-                { 0, "mqtt_2_pass", &SysConfig.mqttStation[1].UserPass, VAR_PASS, RW, 3, 31 },
-                { 0, "mqtt_2_stat", &funct_mqtt_2_stat, VAR_FUNCT, R, 0, 0 },
-                { 0, "mqtt_2_test", &funct_mqtt_2_test, VAR_FUNCT, RW, 0, 0 },
+                [SYSVAR_SLOT(mqtt_2_enab)] = { 0, "mqtt_2_enab", &SysConfig.mqttStation[1].Flags1.bIsGlobalEnabled, VAR_BOOL, RW, 0, 1 },
+                [SYSVAR_SLOT(mqtt_2_serv)] = { 0, "mqtt_2_serv", &SysConfig.mqttStation[1].ServerAddr, VAR_STRING, RW, 3, 63 },
+                [SYSVAR_SLOT(mqtt_2_port)] = { 0, "mqtt_2_port", &SysConfig.mqttStation[1].ServerPort, VAR_INT, RW, 1, 65534 },
+                [SYSVAR_SLOT(mqtt_2_syst)] = { 0, "mqtt_2_syst", &SysConfig.mqttStation[1].SystemName, VAR_STRING, RW, 3, 31 },
+                [SYSVAR_SLOT(mqtt_2_group)] = { 0, "mqtt_2_group", &SysConfig.mqttStation[1].GroupName, VAR_STRING, RW, 3, 31 },
+                [SYSVAR_SLOT(mqtt_2_clid)] = { 0, "mqtt_2_clid", &SysConfig.mqttStation[1].ClientID, VAR_STRING, RW, 3, 31 },
+                [SYSVAR_SLOT(mqtt_2_uname)] = { 0, "mqtt_2_uname", &SysConfig.mqttStation[1].UserName, VAR_STRING, RW, 3, 31 },
+                [SYSVAR_SLOT(mqtt_2_pass)] = { 0, "mqtt_2_pass", &SysConfig.mqttStation[1].UserPass, VAR_PASS, RW, 3, 31 },
+                [SYSVAR_SLOT(mqtt_2_stat)] = { 0, "mqtt_2_stat", &funct_mqtt_2_stat, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(mqtt_2_test)] = { 0, "mqtt_2_test", &funct_mqtt_2_test, VAR_FUNCT, RW, 0, 0 },
 
 #endif
 #endif
 
 #if CONFIG_WEBGUIAPP_ETHERNET_ENABLE
-                { 0, "eth_enab", &SysConfig.ethSettings.Flags1.bIsETHEnabled, VAR_BOOL, RW, 0, 1 },
-                { 0, "eth_isdhcp", &SysConfig.ethSettings.Flags1.bIsDHCPEnabled, VAR_BOOL, RW, 0, 1 },
-                { 0, "eth_ip", &SysConfig.ethSettings.IPAddr, VAR_IPADDR, RW, 0, 0 },
-                { 0, "eth_mask", &SysConfig.ethSettings.Mask, VAR_IPADDR, RW, 0, 0 },
-                { 0, "eth_gw", &SysConfig.ethSettings.Gateway, VAR_IPADDR, RW, 0, 0 },
-                { 0, "eth_dns1", &SysConfig.ethSettings.DNSAddr1, VAR_IPADDR, RW, 0, 0 },
-                { 0, "eth_dns2", &SysConfig.ethSettings.DNSAddr2, VAR_IPADDR, RW, 0, 0 },
-                { 0, "eth_dns3", &SysConfig.ethSettings.DNSAddr3, VAR_IPADDR, RW, 0, 0 },
-                { 0, "eth_stat", &funct_eth_stat, VAR_FUNCT, R, 0, 0 },
-                { 0, "eth_visible", (bool*) (&VAR_TRUE), VAR_BOOL, R, 0, 1 },
-                { 0, "eth_mac", &funct_eth_mac, VAR_FUNCT, R, 0, 0 },
+                [SYSVAR_SLOT(eth_enab)] = { 0, "eth_enab", &SysConfig.ethSettings.Flags1.bIsETHEnabled, VAR_BOOL, RW, 0, 1 },
+                [SYSVAR_SLOT(eth_isdhcp)] = { 0, "eth_isdhcp", &SysConfig.ethSettings.Flags1.bIsDHCPEnabled, VAR_BOOL, RW, 0, 1 },
+                [SYSVAR_SLOT(eth_ip)] = { 0, "eth_ip", &SysConfig.ethSettings.IPAddr, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(eth_mask)] = { 0, "eth_mask", &SysConfig.ethSettings.Mask, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(eth_gw)] = { 0, "eth_gw", &SysConfig.ethSettings.Gateway, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(eth_dns1)] = { 0, "eth_dns1", &SysConfig.ethSettings.DNSAddr1, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(eth_dns2)] = { 0, "eth_dns2", &SysConfig.ethSettings.DNSAddr2, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(eth_dns3)] = { 0, "eth_dns3", &SysConfig.ethSettings.DNSAddr3, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(eth_stat)] = { 0, "eth_stat", &funct_eth_stat, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(eth_visible)] = { 0, "eth_visible", (bool*) (&VAR_TRUE), VAR_BOOL, R, 0, 1 },
+                [SYSVAR_SLOT(eth_mac)] = { 0, "eth_mac", &funct_eth_mac, VAR_FUNCT, RP, 0, 0 },
                 #else
-                { 0, "eth_visible", (bool*) (&VAR_FALSE), VAR_BOOL, R, 0, 1 },
+                [SYSVAR_SLOT(eth_visible)] = { 0, "eth_visible", (bool*) (&VAR_FALSE), VAR_BOOL, R, 0, 1 },
                 #endif
 
 #if CONFIG_WEBGUIAPP_WIFI_ENABLE
-                { 0, "wifi_mode", &SysConfig.wifiSettings.WiFiMode, VAR_INT, RW, 1, 3 },
-                { 0, "wifi_sta_ip", &SysConfig.wifiSettings.InfIPAddr, VAR_IPADDR, RW, 0, 0 },
-                { 0, "wifi_sta_mask", &SysConfig.wifiSettings.InfMask, VAR_IPADDR, RW, 0, 0 },
-                { 0, "wifi_sta_gw", &SysConfig.wifiSettings.InfGateway, VAR_IPADDR, RW, 0, 0 },
-                { 0, "wifi_ap_ip", &SysConfig.wifiSettings.ApIPAddr, VAR_IPADDR, RW, 0, 0 },
-                { 0, "wifi_dns1", &SysConfig.wifiSettings.DNSAddr1, VAR_IPADDR, RW, 0, 0 },
-                { 0, "wifi_dns2", &SysConfig.wifiSettings.DNSAddr2, VAR_IPADDR, RW, 0, 0 },
-                { 0, "wifi_dns3", &SysConfig.wifiSettings.DNSAddr3, VAR_IPADDR, RW, 0, 0 },
-                { 0, "wifi_sta_ssid", &SysConfig.wifiSettings.InfSSID, VAR_STRING, RW, 3, 31 },
-                { 0, "wifi_sta_key", &SysConfig.wifiSettings.InfSecurityKey, VAR_PASS, RW, 8, 31 },
-                { 0, "wifi_ap_ssid", &SysConfig.wifiSettings.ApSSID, VAR_STRING, RW, 3, 31 },
-                { 0, "wifi_ap_key", &SysConfig.wifiSettings.ApSecurityKey, VAR_PASS, RW, 8, 31 },
-
-                { 0, "wifi_enab", &SysConfig.wifiSettings.Flags1.bIsWiFiEnabled, VAR_BOOL, RW, 0, 1 },
-                { 0, "wifi_isdhcp", &SysConfig.wifiSettings.Flags1.bIsDHCPEnabled, VAR_BOOL, RW, 0, 1 },
-                { 0, "wifi_power", &SysConfig.wifiSettings.MaxPower, VAR_INT, RW, 0, 80 },
-                { 0, "wifi_disab_time", &SysConfig.wifiSettings.AP_disab_time, VAR_INT, RW, 0, 60 },
-                { 0, "wifi_sta_mac", &funct_wifi_sta_mac, VAR_FUNCT, R, 0, 0 },
-                { 0, "wifi_ap_mac", &funct_wifi_ap_mac, VAR_FUNCT, R, 0, 0 },
-                { 0, "wifi_stat", &funct_wifi_stat, VAR_FUNCT, R, 0, 0 },
-                { 0, "wifi_scan", &funct_wifiscan, VAR_FUNCT, R, 0, 0 },
-                { 0, "wifi_scan_res", &funct_wifiscanres, VAR_FUNCT, R, 0, 0 },
-                { 0, "wifi_level", &funct_wifi_level, VAR_FUNCT, R, 0, 0 },
+                [SYSVAR_SLOT(wifi_mode)] = { 0, "wifi_mode", &SysConfig.wifiSettings.WiFiMode, VAR_INT, RW, 1, 3 },
+                [SYSVAR_SLOT(wifi_sta_ip)] = { 0, "wifi_sta_ip", &SysConfig.wifiSettings.InfIPAddr, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(wifi_sta_mask)] = { 0, "wifi_sta_mask", &SysConfig.wifiSettings.InfMask, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(wifi_sta_gw)] = { 0, "wifi_sta_gw", &SysConfig.wifiSettings.InfGateway, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(wifi_ap_ip)] = { 0, "wifi_ap_ip", &SysConfig.wifiSettings.ApIPAddr, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(wifi_dns1)] = { 0, "wifi_dns1", &SysConfig.wifiSettings.DNSAddr1, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(wifi_dns2)] = { 0, "wifi_dns2", &SysConfig.wifiSettings.DNSAddr2, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(wifi_dns3)] = { 0, "wifi_dns3", &SysConfig.wifiSettings.DNSAddr3, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(wifi_sta_ssid)] = { 0, "wifi_sta_ssid", &SysConfig.wifiSettings.InfSSID, VAR_STRING, RW, 3, 31 },
+                [SYSVAR_SLOT(wifi_sta_key)] = { 0, "wifi_sta_key", &SysConfig.wifiSettings.InfSecurityKey, VAR_PASS, RW, 8, 31 },
+                [SYSVAR_SLOT(wifi_ap_ssid)] = { 0, "wifi_ap_ssid", &SysConfig.wifiSettings.ApSSID, VAR_STRING, RW, 3, 31 },
+                [SYSVAR_SLOT(wifi_ap_key)] = { 0, "wifi_ap_key", &SysConfig.wifiSettings.ApSecurityKey, VAR_PASS, RW, 8, 31 },
+
+                [SYSVAR_SLOT(wifi_enab)] = { 0, "wifi_enab", &SysConfig.wifiSettings.Flags1.bIsWiFiEnabled, VAR_BOOL, RW, 0, 1 },
+                [SYSVAR_SLOT(wifi_isdhcp)] = { 0, "wifi_isdhcp", &SysConfig.wifiSettings.Flags1.bIsDHCPEnabled, VAR_BOOL, RW, 0, 1 },
+                [SYSVAR_SLOT(wifi_power)] = { 0, "wifi_power", &SysConfig.wifiSettings.MaxPower, VAR_INT, RW, 0, 80 },
+                [SYSVAR_SLOT(wifi_disab_time)] = { 0, "wifi_disab_time", &SysConfig.wifiSettings.AP_disab_time, VAR_INT, RW, 0, 60 },
+                [SYSVAR_SLOT(wifi_sta_mac)] = { 0, "wifi_sta_mac", &funct_wifi_sta_mac, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(wifi_ap_mac)] = { 0, "wifi_ap_mac", &funct_wifi_ap_mac, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(wifi_stat)] = { 0, "wifi_stat", &funct_wifi_stat, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(wifi_scan)] = { 0, "wifi_scan", &funct_wifiscan, VAR_FUNCT, R, 0, 0 },
+                [SYSVAR_SLOT(wifi_scan_res)] = { 0, "wifi_scan_res", &funct_wifiscanres, VAR_FUNCT, R, 0, 0 },
+                [SYSVAR_SLOT(wifi_level)] = { 0, "wifi_level", &funct_wifi_level, VAR_FUNCT, RP, 0, 0, 1000 },
 
 #endif
 
 #if CONFIG_WEBGUIAPP_GPRS_ENABLE
-                { 0, "gsm_enab", &SysConfig.gsmSettings.Flags1.bIsGSMEnabled, VAR_BOOL, RW, 0, 1 },
-                { 0, "gsm_apn", &SysConfig.gsmSettings.APN, VAR_STRING, RW, 3, 31 },
-                { 0, "gsm_apn_login", &SysConfig.gsmSettings.login, VAR_STRING, RW, 3, 31 },
-                { 0, "gsm_apn_password", &SysConfig.gsmSettings.password, VAR_STRING, RW, 3, 31 },
-                { 0, "gsm_module", &funct_gsm_module, VAR_FUNCT, R, 0, 0 },
-                { 0, "gsm_operator", &funct_gsm_operator, VAR_FUNCT, R, 0, 0 },
-                { 0, "gsm_imei", &funct_gsm_imei, VAR_FUNCT, R, 0, 0 },
-                { 0, "gsm_imsi", &funct_gsm_imsi, VAR_FUNCT, R, 0, 0 },
-                { 0, "gsm_ip", &SysConfig.gsmSettings.IPAddr, VAR_IPADDR, RW, 0, 0 },
-                { 0, "gsm_mask", &SysConfig.gsmSettings.Mask, VAR_IPADDR, RW, 0, 0 },
-                { 0, "gsm_gw", &SysConfig.gsmSettings.Gateway, VAR_IPADDR, RW, 0, 0 },
-                { 0, "gsm_dns1", &SysConfig.gsmSettings.DNSAddr1, VAR_IPADDR, RW, 0, 0 },
-                { 0, "gsm_dns2", &SysConfig.gsmSettings.DNSAddr2, VAR_IPADDR, RW, 0, 0 },
-                { 0, "gsm_dns3", &SysConfig.gsmSettings.DNSAddr3, VAR_IPADDR, RW, 0, 0 },
-                { 0, "gsm_stat", &funct_gsm_stat, VAR_FUNCT, R, 0, 0 },
+                [SYSVAR_SLOT(gsm_enab)] = { 0, "gsm_enab", &SysConfig.gsmSettings.Flags1.bIsGSMEnabled, VAR_BOOL, RW, 0, 1 },
+                [SYSVAR_SLOT(gsm_apn)] = { 0, "gsm_apn", &SysConfig.gsmSettings.APN, VAR_STRING, RW, 3, 31 },
+                [SYSVAR_SLOT(gsm_apn_login)] = { 0, "gsm_apn_login", &SysConfig.gsmSettings.login, VAR_STRING, RW, 3, 31 },
+                [SYSVAR_SLOT(gsm_apn_password)] = { 0, "gsm_apn_password", &SysConfig.gsmSettings.password, VAR_STRING, RW, 3, 31 },
+                [SYSVAR_SLOT(gsm_module)] = { 0, "gsm_module", &funct_gsm_module, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(gsm_operator)] = { 0, "gsm_operator", &funct_gsm_operator, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(gsm_imei)] = { 0, "gsm_imei", &funct_gsm_imei, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(gsm_imsi)] = { 0, "gsm_imsi", &funct_gsm_imsi, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(gsm_ip)] = { 0, "gsm_ip", &SysConfig.gsmSettings.IPAddr, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(gsm_mask)] = { 0, "gsm_mask", &SysConfig.gsmSettings.Mask, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(gsm_gw)] = { 0, "gsm_gw", &SysConfig.gsmSettings.Gateway, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(gsm_dns1)] = { 0, "gsm_dns1", &SysConfig.gsmSettings.DNSAddr1, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(gsm_dns2)] = { 0, "gsm_dns2", &SysConfig.gsmSettings.DNSAddr2, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(gsm_dns3)] = { 0, "gsm_dns3", &SysConfig.gsmSettings.DNSAddr3, VAR_IPADDR, RW, 0, 0 },
+                [SYSVAR_SLOT(gsm_stat)] = { 0, "gsm_stat", &funct_gsm_stat, VAR_FUNCT, RP, 0, 0 },
                 #ifdef CONFIG_WEBGUIAPP_MODEM_AT_ACCESS
-                { 0, "gsm_at_timeout", &funct_gsm_at_timeout, VAR_FUNCT, R, 0, 0 },
-                { 0, "gsm_at", &funct_gsm_at, VAR_FUNCT, R, 0, 0 },
+                [SYSVAR_SLOT(gsm_at_timeout)] = { 0, "gsm_at_timeout", &funct_gsm_at_timeout, VAR_FUNCT, R, 0, 0 },
+                [SYSVAR_SLOT(gsm_at)] = { 0, "gsm_at", &funct_gsm_at, VAR_FUNCT, R, 0, 0 },
 #endif
-                { 0, "gsm_rssi", &funct_gsm_rssi, VAR_FUNCT, R, 0, 0 },
-                { 0, "gsm_visible", (bool*) (&VAR_TRUE), VAR_BOOL, R, 0, 1 },
+                [SYSVAR_SLOT(gsm_rssi)] = { 0, "gsm_rssi", &funct_gsm_rssi, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(gsm_visible)] = { 0, "gsm_visible", (bool*) (&VAR_TRUE), VAR_BOOL, R, 0, 1 },
                 #else
-                { 0, "gsm_visible", (bool*) (&VAR_FALSE), VAR_BOOL, R, 0, 1 },
+                [SYSVAR_SLOT(gsm_visible)] = { 0, "gsm_visible", (bool*) (&VAR_FALSE), VAR_BOOL, R, 0, 1 },
                 #endif
 
 #ifdef CONFIG_WEBGUIAPP_UART_TRANSPORT_ENABLE
-                { 0, "serial_enab", &SysConfig.serialSettings.Flags.IsSerialEnabled, VAR_BOOL, RW, 0, 1 },
-                { 0, "serial_bridge", &SysConfig.serialSettings.Flags.IsBridgeEnabled, VAR_BOOL, RW, 0, 1 },
-                { 0, "serial_mode", &funct_serial_mode, VAR_FUNCT, R, 1, 2 },
-                { 0, "serial_baud", &SysConfig.serialSettings.BaudRate, VAR_INT, RW, 1200, 4096000 },
-                { 0, "serial_break", &SysConfig.serialSettings.InputBrake, VAR_INT, RW, 1, 50 },
-                { 0, "serial_visible", (bool*) (&VAR_TRUE), VAR_BOOL, R, 0, 1 },
+                [SYSVAR_SLOT(serial_enab)] = { 0, "serial_enab", &SysConfig.serialSettings.Flags.IsSerialEnabled, VAR_BOOL, RW, 0, 1 },
+                [SYSVAR_SLOT(serial_bridge)] = { 0, "serial_bridge", &SysConfig.serialSettings.Flags.IsBridgeEnabled, VAR_BOOL, RW, 0, 1 },
+                [SYSVAR_SLOT(serial_mode)] = { 0, "serial_mode", &funct_serial_mode, VAR_FUNCT, RP, 1, 2 },
+                [SYSVAR_SLOT(serial_baud)] = { 0, "serial_baud", &SysConfig.serialSettings.BaudRate, VAR_INT, RW, 1200, 4096000 },
+                [SYSVAR_SLOT(serial_break)] = { 0, "serial_break", &SysConfig.serialSettings.InputBrake, VAR_INT, RW, 1, 50 },
+                [SYSVAR_SLOT(serial_visible)] = { 0, "serial_visible", (bool*) (&VAR_TRUE), VAR_BOOL, R, 0, 1 },
                 #else
-                { 0, "serial_visible", (bool*) (&VAR_FALSE), VAR_BOOL, R, 0, 1 },
+                [SYSVAR_SLOT(serial_visible)] = { 0, "serial_visible", (bool*) (&VAR_FALSE), VAR_BOOL, R, 0, 1 },
                 #endif
 
 #ifdef CONFIG_WEBGUIAPP_LORAWAN_ENABLE
-                { 0, "lora_enab", &SysConfig.lorawanSettings.Flags1.bIsLoRaWANEnabled, VAR_BOOL, RW, 0, 1 },
-                { 0, "lora_visible", (bool*) (&VAR_TRUE), VAR_BOOL, R, 0, 1 },
-                { 0, "lora_devid", &funct_lora_devid, VAR_FUNCT, RW, 0, 0 },
-                { 0, "lora_appid", &funct_lora_appid, VAR_FUNCT, RW, 0, 0 },
-                { 0, "lora_appkey", &funct_lora_appkey, VAR_FUNCT, R, 0, 0 },
+                [SYSVAR_SLOT(lora_enab)] = { 0, "lora_enab", &SysConfig.lorawanSettings.Flags1.bIsLoRaWANEnabled, VAR_BOOL, RW, 0, 1 },
+                [SYSVAR_SLOT(lora_visible)] = { 0, "lora_visible", (bool*) (&VAR_TRUE), VAR_BOOL, R, 0, 1 },
+                [SYSVAR_SLOT(lora_devid)] = { 0, "lora_devid", &funct_lora_devid, VAR_FUNCT, RWP, 0, 0 },
+                [SYSVAR_SLOT(lora_appid)] = { 0, "lora_appid", &funct_lora_appid, VAR_FUNCT, RWP, 0, 0 },
+                [SYSVAR_SLOT(lora_appkey)] = { 0, "lora_appkey", &funct_lora_appkey, VAR_FUNCT, R, 0, 0 },
 
 
 #else
-                { 0, "lora_visible", (bool*) (&VAR_FALSE), VAR_BOOL, R, 0, 1 },
+                [SYSVAR_SLOT(lora_visible)] = { 0, "lora_visible", (bool*) (&VAR_FALSE), VAR_BOOL, R, 0, 1 },
                 #endif
 
 #ifdef CONFIG_WEBGUIAPP_MBTCP_ENABLED
-                { 0, "mbtcp_enab", &SysConfig.modbusSettings.IsModbusTCPEnabled, VAR_BOOL, RW, 0, 1 },
-                { 0, "mbtcp_port", &SysConfig.modbusSettings.ModbusTCPPort, VAR_INT, RW, 1, 65534 },
-                { 0, "mbtcp_visible", (bool*) (&VAR_TRUE), VAR_BOOL, R, 0, 1 },
+                [SYSVAR_SLOT(mbtcp_enab)] = { 0, "mbtcp_enab", &SysConfig.modbusSettings.IsModbusTCPEnabled, VAR_BOOL, RW, 0, 1 },
+                [SYSVAR_SLOT(mbtcp_port)] = { 0, "mbtcp_port", &SysConfig.modbusSettings.ModbusTCPPort, VAR_INT, RW, 1, 65534 },
+                [SYSVAR_SLOT(mbtcp_visible)] = { 0, "mbtcp_visible", (bool*) (&VAR_TRUE), VAR_BOOL, R, 0, 1 },
 #else
-                { 0, "mbtcp_visible", (bool*) (&VAR_FALSE), VAR_BOOL, R, 0, 1 },
+                [SYSVAR_SLOT(mbtcp_visible)] = { 0, "mbtcp_visible", (bool*) (&VAR_FALSE), VAR_BOOL, R, 0, 1 },
                 #endif
-                { 0, "cronrecs", &funct_cronrecs, VAR_FUNCT, RW, 0, 0 },
-                { 0, "objsinfo", &funct_objsinfo, VAR_FUNCT, R, 0, 0 },
+                [SYSVAR_SLOT(cronrecs)] = { 0, "cronrecs", &funct_cronrecs, VAR_FUNCT, RW, 0, 0 },
+                [SYSVAR_SLOT(objsinfo)] = { 0, "objsinfo", &funct_objsinfo, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(http_buf_stat)] = { 0, "http_buf_stat", &funct_http_buf_stat, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(http_restarts_avoided)] = { 0, "http_restarts_avoided", &funct_http_restarts_avoided, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(http_upload_stat)] = { 0, "http_upload_stat", &funct_http_upload_stat, VAR_FUNCT, RP, 0, 0 },
+                [SYSVAR_SLOT(vars_cache_stat)] = { 0, "vars_cache_stat", &funct_vars_cache_stat, VAR_FUNCT, RP, 0, 0 },
+#if REAST_API_DEBUG_MODE > 0
+                [SYSVAR_SLOT(vars_lookup_bench)] = { 0, "vars_lookup_bench", &funct_vars_lookup_bench, VAR_FUNCT, R, 0, 0 },
+#endif
+#if CONFIG_WEBGUIAPP_HTTP_METRICS_ENABLE
+                [SYSVAR_SLOT(http_stats)] = { 0, "http_stats", &funct_http_stats, VAR_FUNCT, RP, 0, 0 },
+#endif
+#if CONFIG_WEBGUIAPP_HTTP_RATE_LIMIT_ENABLE
+                [SYSVAR_SLOT(http_limits_stat)] = { 0, "http_limits_stat", &funct_http_limits_stat, VAR_FUNCT, RP, 0, 0 },
+#endif
+#if CONFIG_WEBGUIAPP_HTTP_CACHE_ENABLE
+                [SYSVAR_SLOT(http_cache_stat)] = { 0, "http_cache_stat", &funct_http_cache_stat, VAR_FUNCT, RP, 0, 0 },
+#endif
 
-                { 0, "file_list", &funct_file_list, VAR_FUNCT, R, 0, 0 },
-                { 0, "file_block", &funct_file_block, VAR_FUNCT, R, 0, 0 },
+                [SYSVAR_SLOT(file_list)] = { 0, "file_list", &funct_file_list, VAR_FUNCT, R, 0, 0 },
+                [SYSVAR_SLOT(file_block)] = { 0, "file_block", &funct_file_block, VAR_FUNCT, R, 0, 0 },
                 #if CONFIG_SDCARD_ENABLE
-                { 0, "sd_list", &funct_sd_list, VAR_FUNCT, R, 0, 0 },
-                { 0, "sd_block", &funct_sd_block, VAR_FUNCT, R, 0, 0 },
-                { 0, "sd_visible", (bool*) (&VAR_TRUE), VAR_BOOL, R, 0, 1 }
+                [SYSVAR_SLOT(sd_list)] = { 0, "sd_list", &funct_sd_list, VAR_FUNCT, R, 0, 0 },
+                [SYSVAR_SLOT(sd_block)] = { 0, "sd_block", &funct_sd_block, VAR_FUNCT, R, 0, 0 },
+                [SYSVAR_SLOT(sd_visible)] = { 0, "sd_visible", (bool*) (&VAR_TRUE), VAR_BOOL, R, 0, 1 }
 #else
-                { 0, "sd_visible", (bool*) (&VAR_FALSE), VAR_BOOL, R, 0, 1 },
+                [SYSVAR_SLOT(sd_visible)] = { 0, "sd_visible", (bool*) (&VAR_FALSE), VAR_BOOL, R, 0, 1 },
         #endif
 
         };
 
-esp_err_t SetConfVar(char *name, char *val, rest_var_types *tp)
+/* System variables are found with perfect hash generated at build time
+ * by tools/gen_sysvars_hash.py, SystemVariables is indexed by hash slot.
+ * Application variables are found with binary search in the index sorted
+ * by name. Variable of application shadows system variable with the same
+ * name, within application table the first variable with the name wins.
+ * Index is built by SetAppVars(), so it must be called before servers start */
+typedef struct
 {
-    rest_var_t *V = NULL;
-    //Search for system variables
-    for (int i = 0; i < sizeof(SystemVariables) / sizeof(rest_var_t); ++i)
+    const rest_var_t **vars;
+    int size;
+    uint32_t *versions;
+} conf_vars_index_t;
+
+static conf_vars_index_t *AppVarsIndex = NULL;
+
+static const rest_var_t* FindSysVar(const char *name)
+{
+    uint32_t h = 2166136261u;
+    for (const char *c = name; *c; c++)
+        h = (h ^ (uint8_t) *c) * 16777619u;
+    h = (h ^ SysVarsHashSeeds[h % SYSVARS_HASH_SEEDS]) * 16777619u;
+    const rest_var_t *V = &SystemVariables[h % SYSVARS_HASH_SLOTS];
+    return (V->alias[0] && !strcmp(V->alias, name)) ? V : NULL;
+}
+
+/* Same names are ordered by position, so the first one is kept */
+static int VarIndexCompare(const void *a, const void *b)
+{
+    const rest_var_t *va = *(const rest_var_t**) a;
+    const rest_var_t *vb = *(const rest_var_t**) b;
+    int res = strcmp(va->alias, vb->alias);
+    return (res) ? res : va - vb;
+}
+
+esp_err_t BuildConfVarsIndex(void)
+{
+    if (!AppVars)
+        return ESP_OK;
+    conf_vars_index_t *idx = calloc(1, sizeof(conf_vars_index_t) +
+            AppVarsSize * (sizeof(rest_var_t*) + sizeof(uint32_t)));
+    if (!idx)
+        return ESP_ERR_NO_MEM;
+    idx->versions = (uint32_t*) (idx + 1);
+    idx->vars = (const rest_var_t**) (idx->versions + AppVarsSize);
+    for (int i = 0; i < AppVarsSize; i++)
+        idx->vars[i] = &AppVars[i];
+    qsort(idx->vars, AppVarsSize, sizeof(rest_var_t*), VarIndexCompare);
+    idx->size = 0;
+    for (int i = 0; i < AppVarsSize; i++)
     {
-        if (!strcmp(SystemVariables[i].alias, name))
+        if (idx->size > 0 && !strcmp(idx->vars[idx->size - 1]->alias, idx->vars[i]->alias))
         {
-            V = (rest_var_t*) (&SystemVariables[i]);
-            break;
+            ESP_LOGW(TAG, "Variable '%s' is defined twice", idx->vars[i]->alias);
+            continue;
         }
+        if (FindSysVar(idx->vars[i]->alias))
+            ESP_LOGW(TAG, "Variable '%s' shadows system variable", idx->vars[i]->alias);
+        idx->vars[idx->size++] = idx->vars[i];
     }
-    //Search for user variables
-    if (AppVars)
+    /* Previous index is not freed as it can be used by a lookup right now */
+    AppVarsIndex = idx;
+    return ESP_OK;
+}
+
+static int VarNameCompare(const void *key, const void *elem)
+{
+    return strcmp((const char*) key, (*(const rest_var_t**) elem)->alias);
+}
+
+/* Linear search used if index is not built */
+static rest_var_t* FindAppVarLinear(const char *name)
+{
+    for (int i = 0; AppVars && i < AppVarsSize; ++i)
     {
-        for (int i = 0; i < AppVarsSize; ++i)
-        {
-            if (!strcmp(AppVars[i].alias, name))
-            {
-                V = (rest_var_t*) (&AppVars[i]);
-                break;
-            }
-        }
+        if (!strcmp(AppVars[i].alias, name))
+            return &AppVars[i];
+    }
+    return NULL;
+}
+
+static rest_var_t* FindConfVar(const char *name)
+{
+    conf_vars_index_t *idx = AppVarsIndex;
+    rest_var_t *V;
+    if (idx)
+    {
+        const rest_var_t **v = bsearch(name, idx->vars, idx->size, sizeof(rest_var_t*), VarNameCompare);
+        V = (v) ? (rest_var_t*) *v : NULL;
+    }
+    else
+        V = FindAppVarLinear(name);
+    return (V) ? V : (rest_var_t*) FindSysVar(name);
+}
+
+/* Every change of a variable takes the next generation number as its
+ * version, so client having read generation N gets only variables with
+ * version above N next time. Generations of each boot start from random
+ * epoch, variables not changed since boot (version 0) are reported as of
+ * that epoch. Generation of previous boot is below the epoch or above
+ * the current generation, so client gets full read after reboot */
+static portMUX_TYPE versions_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t ConfVarsEpoch = 0;
+static uint32_t ConfVarsGeneration = 0;
+static uint32_t SysVarsVersions[SYSVARS_HASH_SLOTS];
+
+/* Called inside versions_lock, epoch fits into int of JSON responses */
+static void InitGeneration(void)
+{
+    if (!ConfVarsEpoch)
+        ConfVarsEpoch = ConfVarsGeneration = ((esp_random() & 0x3FFF) + 1) << 16;
+}
+
+static uint32_t* GetVersionRef(const rest_var_t *V)
+{
+    conf_vars_index_t *idx = AppVarsIndex;
+    if (V >= SystemVariables && V < SystemVariables + SYSVARS_HASH_SLOTS)
+        return &SysVarsVersions[V - SystemVariables];
+    if (idx && V >= AppVars && V < AppVars + AppVarsSize)
+        return &idx->versions[V - AppVars];
+    return NULL;
+}
+
+static void TouchVar(const rest_var_t *V)
+{
+    uint32_t *ver = GetVersionRef(V);
+    if (!ver)
+        return;
+    portENTER_CRITICAL(&versions_lock);
+    InitGeneration();
+    *ver = ++ConfVarsGeneration;
+    portEXIT_CRITICAL(&versions_lock);
+}
+
+/* For writers changing SysConfig directly, not with SetConfVar() */
+void ConfVarTouch(const char *name)
+{
+    rest_var_t *V = FindConfVar(name);
+    if (V)
+        TouchVar(V);
+}
+
+uint32_t GetConfVarVersion(const char *name)
+{
+    rest_var_t *V = FindConfVar(name);
+    uint32_t *ver = (V) ? GetVersionRef(V) : NULL;
+    portENTER_CRITICAL(&versions_lock);
+    InitGeneration();
+    uint32_t res = (ver && *ver) ? *ver : ConfVarsEpoch;
+    portEXIT_CRITICAL(&versions_lock);
+    return res;
+}
+
+uint32_t GetConfVarsGeneration(void)
+{
+    portENTER_CRITICAL(&versions_lock);
+    InitGeneration();
+    uint32_t gen = ConfVarsGeneration;
+    portEXIT_CRITICAL(&versions_lock);
+    return gen;
+}
+
+/* Filter of delta reads. Since 0, of previous boot or not issued yet
+ * means full read. Function variables like uptime or *_stat are live
+ * values without versions, so they are always included. Unknown
+ * variable passes to be reported as such */
+bool IsConfVarChangedSince(const char *name, uint32_t since)
+{
+    uint32_t gen = GetConfVarsGeneration();
+    if (since < ConfVarsEpoch || since > gen)
+        return true;
+    rest_var_t *V = FindConfVar(name);
+    if (!V || V->vartype == VAR_FUNCT)
+        return true;
+    return (GetConfVarVersion(name) > since);
+}
+
+#if REAST_API_DEBUG_MODE > 0
+/* Linear search over system variables as it was before hashing, for comparison */
+static const rest_var_t* FindSysVarLinear(const char *name)
+{
+    for (int i = 0; i < SYSVARS_HASH_SLOTS; ++i)
+    {
+        if (SystemVariables[i].alias[0] && !strcmp(SystemVariables[i].alias, name))
+            return &SystemVariables[i];
     }
+    return NULL;
+}
 
+/* Average time of lookup of every system variable with hash and with linear search */
+static void funct_vars_lookup_bench(char *argres, int rw)
+{
+    const int rounds = 10;
+    int vars = 0;
+    for (int i = 0; i < SYSVARS_HASH_SLOTS; i++)
+        if (SystemVariables[i].alias[0])
+            vars++;
+    int lookups = rounds * vars;
+    int64_t t = esp_timer_get_time();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < SYSVARS_HASH_SLOTS; i++)
+            if (SystemVariables[i].alias[0])
+                FindSysVar(SystemVariables[i].alias);
+    int64_t t_hash = esp_timer_get_time() - t;
+    t = esp_timer_get_time();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < SYSVARS_HASH_SLOTS; i++)
+            if (SystemVariables[i].alias[0])
+                FindSysVarLinear(SystemVariables[i].alias);
+    int64_t t_linear = esp_timer_get_time() - t;
+    snprintf(argres, VAR_MAX_VALUE_LENGTH,
+             "{\"vars\":%d,\"app_vars\":%d,\"lookups\":%d,\"hash_ns\":%d,\"linear_ns\":%d}",
+             vars, (AppVarsIndex) ? AppVarsIndex->size : 0, lookups,
+             (int) (t_hash * 1000 / lookups), (int) (t_linear * 1000 / lookups));
+}
+#endif
+
+esp_err_t SetConfVar(char *name, char *val, rest_var_types *tp)
+{
+    rest_var_t *V = FindConfVar(name);
     if (!V)
         return ESP_ERR_NOT_FOUND;
-    if (V->varattr == R)
+    if (!(V->varattr & RW))
         return ESP_OK;
     int constr;
+    bool changed = false;
+    esp_ip4_addr_t prev_ip;
     *tp = V->vartype;
     switch (V->vartype)
     {
         case VAR_BOOL:
             if (!strcmp(val, "true") || !strcmp(val, "1"))
-                *((bool*) V->ref) = true;
+                constr = true;
             else if (!strcmp(val, "false") || !strcmp(val, "0"))
-                *((bool*) V->ref) = 0;
+                constr = false;
             else
                 return ESP_ERR_INVALID_ARG;
+            changed = (*((bool*) V->ref) != constr);
+            *((bool*) V->ref) = constr;
         break;
         case VAR_CHAR:
             constr = atoi(val);
             if (constr < V->minlen || constr > V->maxlen)
                 return ESP_ERR_INVALID_ARG;
+            changed = (*((uint8_t*) V->ref) != constr);
             *((uint8_t*) V->ref) = constr;
         break;
         case VAR_INT:
             constr = atoi(val);
             if (constr < V->minlen || constr > V->maxlen)
                 return ESP_ERR_INVALID_ARG;
+            changed = (*((int*) V->ref) != constr);
             *((int*) V->ref) = constr;
         break;
         case VAR_STRING:
             constr = strlen(val);
             if (constr < V->minlen || constr > V->maxlen)
                 return ESP_ERR_INVALID_ARG;
+            changed = (strcmp(V->ref, val) != 0);
             strcpy(V->ref, val);
         break;
         case VAR_PASS:
@@ -656,46 +1048,107 @@ esp_err_t SetConfVar(char *name, char *val, rest_var_types *tp)
                 constr = strlen(val);
                 if (constr < V->minlen || constr > V->maxlen)
                     return ESP_ERR_INVALID_ARG;
+                changed = (strcmp(V->ref, val) != 0);
                 strcpy(V->ref, val);
             }
         break;
 
         case VAR_IPADDR:
+            prev_ip = *((esp_ip4_addr_t*) V->ref);
             esp_netif_str_to_ip4(val, (esp_ip4_addr_t*) (V->ref));
+            changed = (prev_ip.addr != ((esp_ip4_addr_t*) V->ref)->addr);
         break;
         case VAR_FUNCT:
             ((void (*)(char*, int)) (V->ref))(val, 1);
+            if (V->cachems != VAR_CACHE_LIVE)
+                InvalidateFunctCache(V);
         break;
         case VAR_ERROR:
             break;
 
     }
+    /* Function variables have no versions, they are live values */
+    if (changed)
+        TouchVar(V);
     return ESP_OK;
 }
 
-esp_err_t GetConfVar(char *name, char *val, rest_var_types *tp)
+/* Check if variable can be read without side effects, by plain GET,
+ * wildcard reads or periodically for push to subscribers. Function
+ * variables must be declared with RP or RWP for this */
+bool IsConfVarReadSafe(char *name)
 {
-    rest_var_t *V = NULL;
-    for (int i = 0; i < sizeof(SystemVariables) / sizeof(rest_var_t); ++i)
+    rest_var_t *V = FindConfVar(name);
+    if (!V || V->vartype == VAR_ERROR || V->vartype == VAR_PASS)
+        return false;
+    return (V->vartype != VAR_FUNCT || (V->varattr & RP));
+}
+
+/* Match name with pattern where '*' is any sequence of characters */
+static bool IsNameMatched(const char *pattern, const char *name)
+{
+    const char *star = NULL;
+    const char *back = NULL;
+    while (*name)
     {
-        if (!strcmp(SystemVariables[i].alias, name))
+        if (*pattern == '*')
         {
-            V = (rest_var_t*) (&SystemVariables[i]);
-            break;
+            star = pattern++;
+            back = name;
         }
+        else if (*pattern == *name)
+        {
+            pattern++;
+            name++;
+        }
+        else if (star)
+        {
+            pattern = star + 1;
+            name = ++back;
+        }
+        else
+            return false;
     }
-    //Search for user variables
-    if (AppVars)
+    while (*pattern == '*')
+        pattern++;
+    return (*pattern == 0x00);
+}
+
+/* Walk system and application variables once and call cb for each
+ * variable matching pattern like "wifi_*" or "*". Variables that can't
+ * be read periodically (passwords, actions on read) are skipped, as
+ * well as system variables shadowed by application ones. Variables are
+ * filtered by since with IsConfVarChangedSince().
+ * Returns number of matched variables */
+int ConfVarsForEach(const char *pattern, uint32_t since, void (*cb)(char *name, void *arg), void *arg)
+{
+    int num = 0;
+    for (int i = 0; i < SYSVARS_HASH_SLOTS; i++)
     {
-        for (int i = 0; i < AppVarsSize; ++i)
+        char *name = (char*) SystemVariables[i].alias;
+        if (name[0] && IsNameMatched(pattern, name) && IsConfVarReadSafe(name) &&
+                FindConfVar(name) == &SystemVariables[i] && IsConfVarChangedSince(name, since))
         {
-            if (!strcmp(AppVars[i].alias, name))
-            {
-                V = (rest_var_t*) (&AppVars[i]);
-                break;
-            }
+            cb(name, arg);
+            num++;
         }
     }
+    for (int i = 0; AppVars && i < AppVarsSize; i++)
+    {
+        char *name = AppVars[i].alias;
+        if (IsNameMatched(pattern, name) && IsConfVarReadSafe(name) && FindConfVar(name) == &AppVars[i] &&
+                IsConfVarChangedSince(name, since))
+        {
+            cb(name, arg);
+            num++;
+        }
+    }
+    return num;
+}
+
+esp_err_t GetConfVar(char *name, char *val, rest_var_types *tp)
+{
+    rest_var_t *V = FindConfVar(name);
     if (!V)
         return ESP_ERR_NOT_FOUND;
     *tp = V->vartype;
@@ -720,7 +1173,13 @@ esp_err_t GetConfVar(char *name, char *val, rest_var_types *tp)
             esp_ip4addr_ntoa((const esp_ip4_addr_t*) V->ref, val, 16);
         break;
         case VAR_FUNCT:
-            ((void (*)(char*, int)) (V->ref))(val, 0);
+            if (V->cachems == VAR_CACHE_LIVE)
+                ((void (*)(char*, int)) (V->ref))(val, 0);
+            else if (!ReadFunctCache(V, val))
+            {
+                ((void (*)(char*, int)) (V->ref))(val, 0);
+                StoreFunctCache(V, val);
+            }
         break;
         case VAR_ERROR:
             break;
@@ -40,6 +40,65 @@ void regCustomSaveConf(void (*custom_saveconf)(void))
     CustomSaveConf = custom_saveconf;
 }
 
+/* Response to read request is signed as a whole in the output buffer,
+ * variables not fitting into it are left for the next page. Response
+ * then has "next" in payload and client repeats the request with
+ * "offset" set to it. Reserve is for the tail of response and signature */
+#define READ_RESPONSE_RESERVE 512
+
+typedef struct
+{
+    struct jWriteControl *jwc;
+    char *value;
+    int offset; //variables sent on previous pages
+    int index;  //variables counted so far
+    int next;   //first variable of the next page, 0 if all are sent
+} vars_read_ctx_t;
+
+static bool IsStringVarType(rest_var_types tp)
+{
+    return (tp == VAR_STRING || tp == VAR_IPADDR || tp == VAR_ERROR || tp == VAR_PASS);
+}
+
+static void WriteReadVariable(struct jWriteControl *jwc, char *VarName, char *VarValue, rest_var_types tp)
+{
+    if (IsStringVarType(tp))
+        jwObj_string(jwc, VarName, VarValue);
+    else
+        jwObj_raw(jwc, VarName, VarValue);
+}
+
+/* Count variable for paging, false if it is not on the current page */
+static bool IsOnPage(vars_read_ctx_t *ctx)
+{
+    return (!ctx->next && ctx->index++ >= ctx->offset);
+}
+
+static void WritePagedVariable(vars_read_ctx_t *ctx, char *VarName, char *VarValue, rest_var_types tp)
+{
+    struct jWriteControl *jwc = ctx->jwc;
+    /* String can grow twice by escaping */
+    size_t need = strlen(VarName) + strlen(VarValue) * ((IsStringVarType(tp)) ? 2 : 1) + 8;
+    if ((size_t) (jwc->bufp - jwc->buffer) + need + READ_RESPONSE_RESERVE <= jwc->buflen)
+        WriteReadVariable(jwc, VarName, VarValue, tp);
+    else if (ctx->index - 1 > ctx->offset)
+        ctx->next = ctx->index - 1;
+    else
+        /* Doesn't fit even into empty page */
+        jwObj_string(jwc, VarName, (char*) esp_err_to_name(ESP_ERR_INVALID_SIZE));
+}
+
+static void ReadMatchedVariable(char *name, void *arg)
+{
+    vars_read_ctx_t *ctx = (vars_read_ctx_t*) arg;
+    rest_var_types tp = VAR_ERROR;
+    if (!IsOnPage(ctx))
+        return;
+    ctx->value[0] = 0x00; //don't pass previous value as an argument
+    if (GetConfVar(name, ctx->value, &tp) == ESP_OK)
+        WritePagedVariable(ctx, name, ctx->value, tp);
+}
+
 static sys_error_code PayloadDefaultTypeHandler(data_message_t *MSG)
 {
     struct jReadElement result;
@@ -61,6 +120,19 @@ static sys_error_code PayloadDefaultTypeHandler(data_message_t *MSG)
     jwObj_int(&jwc, "payloadtype", MSG->parsedData.payloadType);
     jwObj_object(&jwc, "payload");
     jwObj_int(&jwc, "applytype", 0);
+
+    /* Request with "since" reads only variables changed after that generation */
+    uint32_t since = 0;
+    jRead(MSG->inputDataBuffer, "{'data'{'payload'{'since'", &result);
+    if (result.dataType == JREAD_NUMBER && MSG->parsedData.msgType == DATA_MESSAGE_TYPE_REQUEST)
+    {
+        since = (uint32_t) jRead_long(MSG->inputDataBuffer, "{'data'{'payload'{'since'", 0);
+        jwObj_int(&jwc, "generation", (int) GetConfVarsGeneration());
+    }
+    vars_read_ctx_t ctx = { .jwc = &jwc };
+    jRead(MSG->inputDataBuffer, "{'data'{'payload'{'offset'", &result);
+    if (result.dataType == JREAD_NUMBER)
+        ctx.offset = jRead_int(MSG->inputDataBuffer, "{'data'{'payload'{'offset'", 0);
     jwObj_object(&jwc, "variables");
 
     jRead(MSG->inputDataBuffer, "{'data'{'payload'{'variables'", &result);
@@ -70,6 +142,7 @@ static sys_error_code PayloadDefaultTypeHandler(data_message_t *MSG)
         char *VarValue = malloc(VAR_MAX_VALUE_LENGTH);
         if (!VarValue)
             return SYS_ERROR_NO_MEMORY;
+        ctx.value = VarValue;
 
         for (int i = 0; i < result.elements; ++i)
         {
@@ -103,17 +176,26 @@ static sys_error_code PayloadDefaultTypeHandler(data_message_t *MSG)
                 }
 
             }
+            else if (strchr(VarName, '*'))
+            { //Read all variables matching the pattern
+                ConfVarsForEach(VarName, since, ReadMatchedVariable, &ctx);
+                continue;
+            }
+            else if (!IsConfVarChangedSince(VarName, since) || !IsOnPage(&ctx))
+                continue;
             else
             { //Read variables
                 res = GetConfVar(VarName, VarValue, &tp);
                 if (res != ESP_OK)
+                {
                     strcpy(VarValue, esp_err_to_name(res));
+                    tp = VAR_ERROR;
+                }
+                WritePagedVariable(&ctx, VarName, VarValue, tp);
+                continue;
             }
             //Response with actual data
-            if (tp == VAR_STRING || tp == VAR_IPADDR || tp == VAR_ERROR || tp == VAR_PASS)
-                jwObj_string(&jwc, VarName, VarValue);
-            else
-                jwObj_raw(&jwc, VarName, VarValue);
+            WriteReadVariable(&jwc, VarName, VarValue, tp);
 
         }
         free(VarValue);
@@ -122,11 +204,16 @@ static sys_error_code PayloadDefaultTypeHandler(data_message_t *MSG)
         return SYS_ERROR_PARSE_VARIABLES;
 
     jwEnd(&jwc);
+    if (ctx.next)
+        jwObj_int(&jwc, "next", ctx.next);
     jwEnd(&jwc);
     GetSysErrorDetales((sys_error_code) MSG->err_code, &err_br, &err_desc);
     jwObj_string(&jwc, "error", (char*) err_br);
     jwObj_string(&jwc, "error_descr", (char*) err_desc);
     jwEnd(&jwc);
+    /* Don't sign truncated data, wildcard read can overflow the buffer */
+    if (jwc.error != JWRITE_OK)
+        return SYS_ERROR_NO_MEMORY;
 
     char *datap = strstr(MSG->outputDataBuffer, "\"data\":");
     if (datap)
@@ -145,7 +232,8 @@ static sys_error_code PayloadDefaultTypeHandler(data_message_t *MSG)
     else
         return SYS_ERROR_SHA256_DATA;
     jwEnd(&jwc);
-    jwClose(&jwc);
+    if (jwClose(&jwc) != JWRITE_OK)
+        return SYS_ERROR_NO_MEMORY;
 
     jRead(MSG->inputDataBuffer, "{'data'{'payload'{'applytype'", &result);
     if (result.elements == 1)
@@ -188,13 +276,11 @@ static sys_error_code DataHeaderParser(data_message_t *MSG)
         return SYS_ERROR_WRONG_JSON_FORMAT;
     MSG->parsedData.msgID = 0;
 
-    char *hashbuf = malloc(MSG->inputDataLength);
-    if (hashbuf == NULL)
-        return SYS_ERROR_NO_MEMORY;
-    jRead_string(MSG->inputDataBuffer, "{'data'", hashbuf, MSG->inputDataLength, 0);
-    if (strlen(hashbuf) > 0)
+    /* Hash the data object in place, request body can be large */
+    jRead(MSG->inputDataBuffer, "{'data'", &result);
+    if (result.dataType == JREAD_OBJECT && result.bytelen > 0)
     {
-        SHA256hmacHash((unsigned char*) hashbuf, strlen(hashbuf), (unsigned char*) "mykey", sizeof("mykey"),
+        SHA256hmacHash((unsigned char*) result.pValue, result.bytelen, (unsigned char*) "mykey", sizeof("mykey"),
                        MSG->parsedData.sha256);
         unsigned char sha_print[32 * 2 + 1];
         BytesToStr(MSG->parsedData.sha256, sha_print, 32);
@@ -202,13 +288,9 @@ static sys_error_code DataHeaderParser(data_message_t *MSG)
 #if REAST_API_DEBUG_MODE
         ESP_LOGI(TAG, "SHA256 of DATA object is %s", sha_print);
 #endif
-        free(hashbuf);
     }
     else
-    {
-        free(hashbuf);
         return SYS_ERROR_PARSE_DATA;
-    }
 
 
     jRead(MSG->inputDataBuffer, "{'signature'", &result);
@@ -30,6 +30,7 @@
 #include "lwip/err.h"
 #include "lwip/sys.h"
 #include "NetTransport.h"
+#include "SystemApplication.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_mac.h"
@@ -126,6 +127,9 @@ static void event_handler(void *arg, esp_event_base_t event_base,
         memcpy(&GetSysConf()->wifiSettings.InfIPAddr, &event->ip_info.ip, sizeof(event->ip_info.ip));
         memcpy(&GetSysConf()->wifiSettings.InfMask, &event->ip_info.netmask, sizeof(event->ip_info.netmask));
         memcpy(&GetSysConf()->wifiSettings.InfGateway, &event->ip_info.gw, sizeof(event->ip_info.gw));
+        ConfVarTouch("wifi_sta_ip");
+        ConfVarTouch("wifi_sta_mask");
+        ConfVarTouch("wifi_sta_gw");
         ESP_LOGI(TAG, "WIFI Got IP Address");
         ESP_LOGI(TAG, "~~~~~~~~~~~");
         ESP_LOGI(TAG, "WIFIIP:" IPSTR, IP2STR(&ip_info->ip));
@@ -141,6 +145,9 @@ static void event_handler(void *arg, esp_event_base_t event_base,
         memcpy(&GetSysConf()->wifiSettings.InfIPAddr, &event->ip_info.ip, sizeof(event->ip_info.ip));
         memcpy(&GetSysConf()->wifiSettings.InfMask, &event->ip_info.netmask, sizeof(event->ip_info.netmask));
         memcpy(&GetSysConf()->wifiSettings.InfGateway, &event->ip_info.gw, sizeof(event->ip_info.gw));
+        ConfVarTouch("wifi_sta_ip");
+        ConfVarTouch("wifi_sta_mask");
+        ConfVarTouch("wifi_sta_gw");
         ESP_LOGI(TAG, "WIFI Lost IP Address");
         ESP_LOGI(TAG, "~~~~~~~~~~~");
         ESP_LOGI(TAG, "WIFIIP:" IPSTR, IP2STR(&ip_info->ip));
@@ -22,8 +22,13 @@
  */
 
 #include "romfs.h"
+#include "HTTPServer.h"
+#include "Helpers.h"
+#include "esp_log.h"
+#include <string.h>
+#include <stdlib.h>
 
-espfs_fs_t *fs;
+static const char *TAG = "romfs";
 
 extern const uint8_t espfs_bin[];
 espfs_fs_t *fs;
@@ -31,10 +36,156 @@ espfs_config_t espfs_config = {
         .addr = espfs_bin,
 };
 
+static const char GZIP_SIGN[] = { 0x1f, 0x8b, 0x08 };
+
+static romfs_asset_t *assets = NULL;
+static int assets_num = 0;
+
+/* espfs paths are stored without leading slash */
+static const char* SkipSlashes(const char *path)
+{
+    while (*path == '/')
+        path++;
+    return path;
+}
+
+static int AssetCompare(const void *a, const void *b)
+{
+    return strcmp(((const romfs_asset_t*) a)->path, ((const romfs_asset_t*) b)->path);
+}
+
+/* Encoding of precompressed variant by file name suffix */
+static const char* GetVariantEncoding(const char *path, size_t *baselen)
+{
+    size_t len = strlen(path);
+    if (len > 3 && !strcmp(&path[len - 3], ".gz"))
+    {
+        *baselen = len - 3;
+        return "gzip";
+    }
+    if (len > 3 && !strcmp(&path[len - 3], ".br"))
+    {
+        *baselen = len - 3;
+        return "br";
+    }
+    return NULL;
+}
+
+/* Strong ETag is built from CRC32 of the file content and the file size.
+ * Files not compressed by espfs are accessible directly in the mapped image */
+static void InitAsset(romfs_asset_t *asset)
+{
+    uint8_t buf[512];
+    uint32_t crc = 0;
+    ssize_t len;
+    void *data;
+    size_t baselen;
+    asset->encoding = GetVariantEncoding(asset->path, &baselen);
+    if (asset->encoding)
+    {
+        /* Variant has content type of the original file */
+        char base[FILE_PATH_MAX];
+        strlcpy(base, asset->path, MIN(baselen + 1, sizeof(base)));
+        asset->mime = GetMIMEType(base);
+    }
+    else
+        asset->mime = GetMIMEType(asset->path);
+    espfs_file_t *file = espfs_fopen(fs, asset->path);
+    if (!file)
+        return;
+    if (espfs_faccess(file, &data) == asset->size)
+    {
+        asset->data = data;
+        if (!asset->encoding && asset->size >= sizeof(GZIP_SIGN) && !memcmp(data, GZIP_SIGN, sizeof(GZIP_SIGN)))
+            asset->encoding = "gzip";
+        crc = crc32(crc, (uint8_t const*) data, asset->size);
+    }
+    else
+    {
+        bool first = true;
+        while ((len = espfs_fread(file, buf, sizeof(buf))) > 0)
+        {
+            if (first && !asset->encoding && len >= sizeof(GZIP_SIGN) && !memcmp(buf, GZIP_SIGN, sizeof(GZIP_SIGN)))
+                asset->encoding = "gzip";
+            first = false;
+            crc = crc32(crc, buf, len);
+        }
+    }
+    espfs_fclose(file);
+    snprintf(asset->etag, ROMFS_ETAG_LENGTH, "\"%08lx-%x\"", (unsigned long) crc, (unsigned int) asset->size);
+}
+
+/* Link precompressed variants to the identity file with the same base name */
+static void LinkVariants(void)
+{
+    char base[FILE_PATH_MAX];
+    size_t baselen;
+    romfs_asset_t key = { .path = base };
+    for (int i = 0; i < assets_num; i++)
+    {
+        const char *enc = GetVariantEncoding(assets[i].path, &baselen);
+        if (!enc || baselen >= sizeof(base))
+            continue;
+        strlcpy(base, assets[i].path, baselen + 1);
+        romfs_asset_t *orig = bsearch(&key, assets, assets_num, sizeof(romfs_asset_t), AssetCompare);
+        if (!orig)
+            continue;
+        if (!strcmp(enc, "gzip"))
+            orig->gz = &assets[i];
+        else
+            orig->br = &assets[i];
+    }
+}
+
+static void BuildAssetsTable(void)
+{
+    const char *path;
+    struct espfs_stat_t stat;
+    int num = 0;
+
+    while (espfs_get_path(fs, num) != NULL)
+        num++;
+    assets = calloc(num, sizeof(romfs_asset_t));
+    if (!assets)
+    {
+        ESP_LOGE(TAG, "Failed to allocate memory for assets table");
+        return;
+    }
+    for (int i = 0; i < num; i++)
+    {
+        path = espfs_get_path(fs, i);
+        if (!espfs_stat(fs, path, &stat) || stat.type != ESPFS_TYPE_FILE)
+            continue;
+        assets[assets_num].path = SkipSlashes(path);
+        assets[assets_num].size = stat.size;
+        InitAsset(&assets[assets_num]);
+        assets_num++;
+    }
+    qsort(assets, assets_num, sizeof(romfs_asset_t), AssetCompare);
+    LinkVariants();
+#if CONFIG_WEBGUIAPP_HTTP_TEMPLATES_ENABLE
+    for (int i = 0; i < assets_num; i++)
+    {
+        if (!assets[i].encoding && !strcmp(assets[i].mime, "text/html"))
+            assets[i].tpl = HTTPTemplateParse(&assets[i]);
+    }
+#endif
+    ESP_LOGI(TAG, "Assets table built, %d files", assets_num);
+}
+
+const romfs_asset_t* GetROMAsset(const char *path)
+{
+    romfs_asset_t key = { .path = SkipSlashes(path) };
+    if (!assets)
+        return NULL;
+    return bsearch(&key, assets, assets_num, sizeof(romfs_asset_t), AssetCompare);
+}
+
 void init_rom_fs(const char *root)
 {
     fs = espfs_init(&espfs_config);
     assert(fs != NULL);
+    BuildAssetsTable();
     /*
     esp_vfs_espfs_conf_t vfs_espfs_conf = {
             .base_path = root,
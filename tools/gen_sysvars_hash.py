@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+# Copyright 2026 Bogdan Pilyugin
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# Generates perfect hash of the SystemVariables aliases.
+# Usage: gen_sysvars_hash.py RestApiHandler.c SysVarsHash.h
+#
+# All entries of the table are taken regardless of #if sections, so the
+# table is indexed by slot and entries excluded by configuration stay empty.
+# Slot of the name is computed in two steps: FNV-1a hash of the name selects
+# the seed from the seeds table, then the hash mixed with the seed selects
+# the slot. Seeds are searched so that no two names share a slot.
+
+import re
+import sys
+
+FNV_OFFSET = 2166136261
+FNV_PRIME = 16777619
+MASK = 0xffffffff
+
+ENTRY_RE = re.compile(r'^\s*\[SYSVAR_SLOT\((\w+)\)\]\s*=', re.MULTILINE)
+
+
+def fnv1a(name):
+    h = FNV_OFFSET
+    for c in name.encode():
+        h = ((h ^ c) * FNV_PRIME) & MASK
+    return h
+
+
+def slot(h, seed, slots):
+    return (((h ^ seed) * FNV_PRIME) & MASK) % slots
+
+
+def build(names):
+    slots = len(names) + len(names) // 4 + 1
+    buckets = max(1, len(names) // 3)
+    groups = [[] for _ in range(buckets)]
+    for name in names:
+        h = fnv1a(name)
+        groups[h % buckets].append((name, h))
+    seeds = [0] * buckets
+    used = [None] * slots
+    # Largest groups are placed first while there are many free slots
+    for b in sorted(range(buckets), key=lambda i: -len(groups[i])):
+        if not groups[b]:
+            continue
+        for seed in range(1, 0x10000):
+            pos = [slot(h, seed, slots) for _, h in groups[b]]
+            if len(set(pos)) == len(pos) and all(used[p] is None for p in pos):
+                for (name, _), p in zip(groups[b], pos):
+                    used[p] = name
+                seeds[b] = seed
+                break
+        else:
+            sys.exit('Perfect hash of system variables not found')
+    return slots, seeds, used
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit('Usage: gen_sysvars_hash.py RestApiHandler.c SysVarsHash.h')
+    with open(sys.argv[1], encoding='utf-8') as f:
+        src = f.read()
+    # Entries commented out with // are skipped
+    src = re.sub(r'//.*', '', src)
+    names = list(dict.fromkeys(ENTRY_RE.findall(src)))
+    if not names:
+        sys.exit('No system variables found in ' + sys.argv[1])
+    slots, seeds, used = build(names)
+
+    out = []
+    out.append('/* Generated by tools/gen_sysvars_hash.py from RestApiHandler.c, do not edit */')
+    out.append('#ifndef SYSVARSHASH_H_')
+    out.append('#define SYSVARSHASH_H_')
+    out.append('')
+    out.append('#include <stdint.h>')
+    out.append('')
+    out.append('#define SYSVARS_HASH_SLOTS %d' % slots)
+    out.append('#define SYSVARS_HASH_SEEDS %d' % len(seeds))
+    out.append('#define SYSVAR_SLOT(name) SYSVAR_SLOT_##name')
+    out.append('')
+    for i, name in enumerate(used):
+        if name is not None:
+            out.append('#define SYSVAR_SLOT_%s %d' % (name, i))
+    out.append('')
+    out.append('static const uint16_t SysVarsHashSeeds[SYSVARS_HASH_SEEDS] = {')
+    for i in range(0, len(seeds), 12):
+        out.append('        ' + ', '.join(str(s) for s in seeds[i:i + 12]) + ',')
+    out.append('};')
+    out.append('')
+    out.append('#endif /* SYSVARSHASH_H_ */')
+    text = '\n'.join(out) + '\n'
+
+    # Keep the file untouched if nothing changed to avoid rebuilds
+    try:
+        with open(sys.argv[2], encoding='utf-8') as f:
+            if f.read() == text:
+                return
+    except OSError:
+        pass
+    with open(sys.argv[2], 'w', encoding='utf-8') as f:
+        f.write(text)
+
+
+if __name__ == '__main__':
+    main()